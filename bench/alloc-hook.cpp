@@ -0,0 +1,102 @@
+/**
+ * @file alloc-hook.cpp
+ * @author lymslive
+ * @date 2022-05-10
+ * @brief Replace global operator new and delete to count allocations.
+ * @note Size of freed block is taken by malloc_usable_size(), so the bytes
+ * are a little more than requested, but consistent between new and delete.
+ * */
+#include "alloc-hook.h"
+#include <stdlib.h>
+#include <malloc.h>
+#include <new>
+
+namespace
+{
+
+thread_local bench::CAllocStat s_stAlloc;
+
+void* AllocBlock(size_t nSize) noexcept
+{
+    void* p = malloc(nSize == 0 ? 1 : nSize);
+    if (p != nullptr)
+    {
+        bench::CAllocStat& stat = s_stAlloc;
+        size_t nUsable = malloc_usable_size(p);
+        stat.m_nCount++;
+        stat.m_nBytes += nUsable;
+        stat.m_nLive += nUsable;
+        if (stat.m_nLive > stat.m_nPeak)
+        {
+            stat.m_nPeak = stat.m_nLive;
+        }
+    }
+    return p;
+}
+
+void FreeBlock(void* p) noexcept
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+    bench::CAllocStat& stat = s_stAlloc;
+    size_t nUsable = malloc_usable_size(p);
+    // block allocated in other thread may be freed here
+    stat.m_nLive = stat.m_nLive > nUsable ? stat.m_nLive - nUsable : 0;
+    free(p);
+}
+
+} // namespace
+
+void* operator new(size_t nSize)
+{
+    void* p = AllocBlock(nSize);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t nSize)
+{
+    return operator new(nSize);
+}
+
+void* operator new(size_t nSize, const std::nothrow_t&) noexcept
+{
+    return AllocBlock(nSize);
+}
+
+void* operator new[](size_t nSize, const std::nothrow_t&) noexcept
+{
+    return AllocBlock(nSize);
+}
+
+void operator delete(void* p) noexcept { FreeBlock(p); }
+void operator delete[](void* p) noexcept { FreeBlock(p); }
+void operator delete(void* p, size_t) noexcept { FreeBlock(p); }
+void operator delete[](void* p, size_t) noexcept { FreeBlock(p); }
+
+namespace bench
+{
+
+uint64_t AllocCount()
+{
+    return s_stAlloc.m_nCount;
+}
+
+const CAllocStat& AllocStat()
+{
+    return s_stAlloc;
+}
+
+uint64_t AllocResetPeak()
+{
+    uint64_t nPeak = s_stAlloc.m_nPeak;
+    s_stAlloc.m_nPeak = s_stAlloc.m_nLive;
+    return nPeak;
+}
+
+} /* bench */
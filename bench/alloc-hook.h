@@ -0,0 +1,88 @@
+/**
+ * @file alloc-hook.h
+ * @author lymslive
+ * @date 2022-05-10
+ * @brief Count heap allocations by global operator new, for test and bench.
+ * @details The hook in alloc-hook.cpp replaces global operator new and
+ * delete, so it is only linked into utest-cliop and bench-cliop, never into
+ * the library. The counters are per thread. Usage:
+ * @code
+ * bench::CAllocScope scope;
+ * env.Feed(argc, argv);
+ * COUT(scope.Count() <= 4, true);
+ * @endcode
+ * */
+#ifndef ALLOC_HOOK_H__
+#define ALLOC_HOOK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace bench
+{
+
+/** Allocation counters of the current thread. */
+struct CAllocStat
+{
+    uint64_t m_nCount = 0;      //< times of operator new
+    uint64_t m_nBytes = 0;      //< total bytes allocated
+    uint64_t m_nLive = 0;       //< bytes allocated and not freed yet
+    uint64_t m_nPeak = 0;       //< max of m_nLive since reset
+};
+
+/** Count of heap allocations in the current thread. */
+uint64_t AllocCount();
+
+/** Current counters of the current thread. */
+const CAllocStat& AllocStat();
+
+/** Reset the peak to current live bytes, return the old peak. */
+uint64_t AllocResetPeak();
+
+/** Measure allocations in a scope, such as one `Feed()` call.
+ * @note Peak is reset on construction, so nested scopes are not supported.
+ * */
+class CAllocScope
+{
+    CAllocStat m_stBegin;
+
+public:
+    CAllocScope() { Reset(); }
+
+    /** Start measuring again from now. */
+    void Reset()
+    {
+        AllocResetPeak();
+        m_stBegin = AllocStat();
+    }
+
+    /** Allocations since the scope begin. */
+    uint64_t Count() const { return AllocStat().m_nCount - m_stBegin.m_nCount; }
+
+    /** Bytes allocated since the scope begin, including freed ones. */
+    uint64_t Bytes() const { return AllocStat().m_nBytes - m_stBegin.m_nBytes; }
+
+    /** Max bytes held at the same time more than the scope begin. */
+    uint64_t Peak() const
+    {
+        uint64_t nPeak = AllocStat().m_nPeak;
+        return nPeak > m_stBegin.m_nLive ? nPeak - m_stBegin.m_nLive : 0;
+    }
+};
+
+/** Measure allocations of calling `fn()` once. */
+template <typename funcT>
+CAllocStat AllocMeasure(funcT fn)
+{
+    CAllocScope scope;
+    fn();
+    CAllocStat stat;
+    stat.m_nCount = scope.Count();
+    stat.m_nBytes = scope.Bytes();
+    stat.m_nPeak = scope.Peak();
+    return stat;
+}
+
+} /* bench */
+
+#endif /* end of include guard: ALLOC_HOOK_H__ */
@@ -0,0 +1,140 @@
+/**
+ * @file bench-main.cpp
+ * @author lymslive
+ * @date 2022-05-08
+ * @brief Run registered benchmark cases, report ns/op and allocations/op.
+ * @details Options:
+ *   --filter=word  only run cases whose name contains the word
+ *   --min-time=ms  minimal time of each case, default 200
+ *   --csv          print in csv for diff, one case per line
+ *   --list         only list the case names
+ * */
+#include "bench.h"
+#include "cliop.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct CBenchCase
+{
+    const char* m_pName;
+    std::vector<int> m_vecParam;
+    bench::FBench m_fn;
+};
+
+std::vector<CBenchCase>& Cases()
+{
+    static std::vector<CBenchCase> s_vecCase;
+    return s_vecCase;
+}
+
+/** Run the case with more iterations until reach the minimal time. */
+bench::CState RunCase(const CBenchCase& stCase, int iParam, double fMinNs)
+{
+    size_t nIter = 1;
+    while (true)
+    {
+        bench::CState state(iParam, nIter);
+        stCase.m_fn(state);
+        double fElapsed = state.Nanoseconds();
+        if (fElapsed >= fMinNs || nIter >= 1000000000)
+        {
+            return state;
+        }
+        double fScale = fElapsed > 0 ? fMinNs * 1.2 / fElapsed : 10;
+        fScale = fScale > 10 ? 10 : (fScale < 2 ? 2 : fScale);
+        nIter = static_cast<size_t>(nIter * fScale);
+    }
+}
+
+std::string Format(double fValue)
+{
+    char szBuffer[32];
+    snprintf(szBuffer, sizeof(szBuffer), "%.1f", fValue);
+    return szBuffer;
+}
+
+} // namespace
+
+namespace bench
+{
+
+int Register(const char* pName, std::initializer_list<int> listParam, FBench fn)
+{
+    Cases().push_back(CBenchCase{pName, listParam, fn});
+    return Cases().size();
+}
+
+} /* bench */
+
+int main(int argc, const char* argv[])
+{
+    std::string strFilter;
+    int iMinTime = 200;
+    bool bCsv = false;
+    bool bList = false;
+
+    cli::CEnvBase env;
+    env.Command("bench-cliop", "Run micro benchmark of cliop parser and utilities.");
+    env.Set("--filter=", "only run cases whose name contains it", strFilter)
+        .Set("--min-time= [200]", "minimal milliseconds of each case", iMinTime)
+        .Flag('\0', "csv", "print in csv for diff", bCsv)
+        .Flag('l', "list", "only list the case names", bList)
+        .Set("--config= [NONE]", "no config file");
+    int nRet = env.Feed(argc, argv);
+    if (nRet != 0)
+    {
+        return nRet == cli::ERROR_CODE_HELP ? 0 : nRet;
+    }
+
+    util::CTextAlign stTable(40, 2);
+    std::vector<std::string> vecRow = {"case", "param", "iterations", "ns/op", "allocs/op"};
+    if (bCsv)
+    {
+        printf("case,param,iterations,ns_per_op,allocs_per_op\n");
+    }
+    else if (!bList)
+    {
+        stTable.AddLine(vecRow);
+    }
+
+    for (const CBenchCase& stCase : Cases())
+    {
+        if (!strFilter.empty() && std::string(stCase.m_pName).find(strFilter) == std::string::npos)
+        {
+            continue;
+        }
+        if (bList)
+        {
+            printf("%s\n", stCase.m_pName);
+            continue;
+        }
+        for (int iParam : stCase.m_vecParam)
+        {
+            bench::CState state = RunCase(stCase, iParam, iMinTime * 1e6);
+            double fNsOp = state.Nanoseconds() / state.Iterations();
+            double fAllocOp = static_cast<double>(state.Allocations()) / state.Iterations();
+            if (bCsv)
+            {
+                printf("%s,%d,%zu,%.1f,%.1f\n", stCase.m_pName, iParam, state.Iterations(), fNsOp, fAllocOp);
+                fflush(stdout);
+            }
+            else
+            {
+                vecRow = {stCase.m_pName, std::to_string(iParam), std::to_string(state.Iterations()),
+                    Format(fNsOp), Format(fAllocOp)};
+                stTable.AddLine(vecRow);
+            }
+        }
+    }
+
+    if (!bCsv && !bList)
+    {
+        printf("%s", stTable.GetText().c_str());
+    }
+    return 0;
+}
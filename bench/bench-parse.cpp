@@ -0,0 +1,590 @@
+/**
+ * @file bench-parse.cpp
+ * @author lymslive
+ * @date 2022-05-08
+ * @brief Benchmark cases of cmdline parser: Feed, batch, Get, bind, config,
+ * Usage() and sub-command, with option count or argument count as parameter.
+ * */
+#include "bench.h"
+#include "bench-spec.h"
+#include "util-string.h"
+#include <stdio.h>
+#include <fstream>
+
+namespace bench
+{
+
+std::vector<CSpecOption> MakeSpecOptions(int nOption)
+{
+    static const char* s_aGroup[] = {"codec", "filter", "format", "warn", "optimize",
+        "debug", "link", "preproc", "output", "input", "audio", "video"};
+    static const char* s_aWord[] = {"level", "enable-cache", "strict", "threads", "profile",
+        "max-size", "no-inline", "pixel-format", "sample-rate", "search-path"};
+    const int nGroup = sizeof(s_aGroup) / sizeof(s_aGroup[0]);
+    const int nWord = sizeof(s_aWord) / sizeof(s_aWord[0]);
+
+    std::vector<CSpecOption> vecOption(nOption);
+    for (int i = 0; i < nOption; ++i)
+    {
+        CSpecOption& stOption = vecOption[i];
+        stOption.m_strLongName = std::string(s_aGroup[i % nGroup]) + "." + s_aWord[(i / nGroup) % nWord]
+            + "-" + std::to_string(i);
+        if (i < 26)
+        {
+            stOption.m_cShortName = 'a' + i;
+        }
+        stOption.m_bFlag = i % 4 == 0;
+        stOption.m_bRepeated = !stOption.m_bFlag && i % 10 == 1;
+        if (!stOption.m_bFlag && i % 5 == 2)
+        {
+            stOption.m_strDefault = std::to_string(i);
+        }
+    }
+    return vecOption;
+}
+
+void MakeSpec(cli::CEnvBase& env, const std::vector<CSpecOption>& vecOption)
+{
+    for (const CSpecOption& stOption : vecOption)
+    {
+        if (stOption.m_bFlag)
+        {
+            env.Flag(stOption.m_cShortName, stOption.m_strLongName, "generated flag");
+        }
+        else
+        {
+            int uAttr = cli::OPTION_ARGUMENT | (stOption.m_bRepeated ? cli::OPTION_REPEATED : 0);
+            env.Option(stOption.m_cShortName, stOption.m_strLongName, "generated option", stOption.m_strDefault, uAttr);
+        }
+    }
+    env.Option('\0', "config", "no config file", "NONE");
+    env.Freeze();
+}
+
+std::vector<std::string> MakeCmdline(const std::vector<CSpecOption>& vecOption, int nUse)
+{
+    std::vector<std::string> vecArgs;
+    for (int k = 0; k < nUse; ++k)
+    {
+        const CSpecOption& stOption = vecOption[(k * 7919) % vecOption.size()];
+        if (stOption.m_bFlag)
+        {
+            vecArgs.push_back("--" + stOption.m_strLongName);
+        }
+        else if (stOption.m_cShortName != '\0' && k % 2 == 0)
+        {
+            vecArgs.push_back(std::string("-") + stOption.m_cShortName);
+            vecArgs.push_back("value" + std::to_string(k));
+        }
+        else
+        {
+            vecArgs.push_back("--" + stOption.m_strLongName + "=value" + std::to_string(k));
+        }
+    }
+    return vecArgs;
+}
+
+std::vector<const char*> MakeArgv(const std::vector<std::string>& vecArgs)
+{
+    std::vector<const char*> vecArgv;
+    vecArgv.push_back("bench");
+    for (const std::string& strArg : vecArgs)
+    {
+        vecArgv.push_back(strArg.c_str());
+    }
+    vecArgv.push_back(nullptr);
+    return vecArgv;
+}
+
+} /* bench */
+
+using namespace bench;
+
+DEF_BENCH(feed_option, 10, 100, 500, 1000)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(state.Param());
+    cli::CEnvBase env;
+    MakeSpec(env, vecOption);
+    std::vector<std::string> vecArgs = MakeCmdline(vecOption, 20);
+    std::vector<const char*> vecArgv = MakeArgv(vecArgs);
+    while (state.Loop())
+    {
+        Keep(env.Feed(vecArgv.size() - 1, vecArgv.data()));
+    }
+}
+
+DEF_BENCH(feed_vector, 10, 100, 500, 1000)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(state.Param());
+    cli::CEnvBase env;
+    MakeSpec(env, vecOption);
+    std::vector<std::string> vecArgs = MakeCmdline(vecOption, 20);
+    while (state.Loop())
+    {
+        Keep(env.Feed(vecArgs));
+    }
+}
+
+// register `Param` options to a new env, cost per option is ns/op / Param
+DEF_BENCH(regist_option, 10, 100, 1000, 10000)
+{
+    std::vector<std::string> vecNames(state.Param());
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        vecNames[i] = "option.name." + std::to_string(i);
+    }
+    while (state.Loop())
+    {
+        cli::CEnvBase env;
+        env.SetOptionOnly().Set("--config= [NONE]", "not load config");
+        for (const std::string& strName : vecNames)
+        {
+            env.Option('\0', strName, "generated option");
+        }
+        Keep(env.OptionId(vecNames.back()));
+    }
+}
+
+// feed all of `Param` options, cost per option is ns/op / Param
+DEF_BENCH(feed_all_option, 10, 100, 1000, 10000)
+{
+    cli::CEnvBase env;
+    env.SetOptionOnly().Set("--config= [NONE]", "not load config");
+    std::vector<std::string> vecArgs(state.Param());
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        std::string strName = "option.name." + std::to_string(i);
+        env.Option('\0', strName, "generated option");
+        vecArgs[i] = "--" + strName + "=" + std::to_string(i);
+    }
+    while (state.Loop())
+    {
+        Keep(env.Feed(vecArgs));
+    }
+}
+
+DEF_BENCH(feed_argument, 10, 100, 1000, 10000)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(50);
+    cli::CEnvBase env;
+    MakeSpec(env, vecOption);
+    std::vector<std::string> vecArgs = MakeCmdline(vecOption, 5);
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        vecArgs.push_back("input-file-" + std::to_string(i) + ".txt");
+    }
+    std::vector<const char*> vecArgv = MakeArgv(vecArgs);
+    while (state.Loop())
+    {
+        Keep(env.Feed(vecArgv.size() - 1, vecArgv.data()));
+    }
+}
+
+DEF_BENCH(feed_repeated, 10, 100, 1000)
+{
+    cli::CEnvBase env;
+    env.Set("-e --expr=+", "repeated expression").Set("--config= [NONE]", "no config");
+    std::vector<std::string> vecArgs;
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        vecArgs.push_back("-e");
+        vecArgs.push_back("expr" + std::to_string(i));
+    }
+    std::vector<const char*> vecArgv = MakeArgv(vecArgs);
+    while (state.Loop())
+    {
+        Keep(env.Feed(vecArgv.size() - 1, vecArgv.data()));
+    }
+}
+
+DEF_BENCH(get_option, 10, 100, 500, 1000)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(state.Param());
+    cli::CEnvBase env;
+    MakeSpec(env, vecOption);
+    std::vector<std::string> vecArgs = MakeCmdline(vecOption, 20);
+    std::vector<const char*> vecArgv = MakeArgv(vecArgs);
+    env.Feed(vecArgv.size() - 1, vecArgv.data());
+    size_t iName = 0;
+    while (state.Loop())
+    {
+        Keep(env.Get(vecOption[iName].m_strLongName));
+        iName = (iName + 7919) % vecOption.size();
+    }
+}
+
+DEF_BENCH(get_typed, 10, 100, 500, 1000)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(state.Param());
+    cli::CEnvBase env;
+    MakeSpec(env, vecOption);
+    std::vector<std::string> vecArgs;
+    for (const CSpecOption& stOption : vecOption)
+    {
+        if (!stOption.m_bFlag)
+        {
+            vecArgs.push_back("--" + stOption.m_strLongName + "=42");
+        }
+    }
+    env.Feed(vecArgs);
+    size_t iName = 0;
+    while (state.Loop())
+    {
+        Keep(env.Get<int>(vecOption[iName].m_strLongName));
+        iName = (iName + 7919) % vecOption.size();
+    }
+}
+
+// convert each time without cache, compare with get_typed
+DEF_BENCH(get_convert, 10, 100, 500, 1000)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(state.Param());
+    cli::CEnvBase env;
+    MakeSpec(env, vecOption);
+    std::vector<std::string> vecArgs;
+    for (const CSpecOption& stOption : vecOption)
+    {
+        if (!stOption.m_bFlag)
+        {
+            vecArgs.push_back("--" + stOption.m_strLongName + "=42");
+        }
+    }
+    env.Feed(vecArgs);
+    size_t iName = 0;
+    while (state.Loop())
+    {
+        int iArg = 0;
+        env.Get(vecOption[iName].m_strLongName, iArg);
+        Keep(iArg);
+        iName = (iName + 7919) % vecOption.size();
+    }
+}
+
+DEF_BENCH(feed_bind, 10, 100, 500)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(state.Param());
+    cli::CEnvBase env;
+    MakeSpec(env, vecOption);
+    std::vector<int> vecInt(vecOption.size());
+    std::vector<std::string> vecStr(vecOption.size());
+    std::vector<std::string> vecArgs;
+    for (size_t i = 0; i < vecOption.size(); ++i)
+    {
+        const CSpecOption& stOption = vecOption[i];
+        if (stOption.m_bFlag || stOption.m_bRepeated)
+        {
+            continue;
+        }
+        if (i % 2 == 0)
+        {
+            env.Bind(stOption.m_strLongName, vecInt[i]);
+        }
+        else
+        {
+            env.Bind(stOption.m_strLongName, vecStr[i]);
+        }
+        vecArgs.push_back("--" + stOption.m_strLongName + "=" + std::to_string(i));
+    }
+    env.Freeze();
+    while (state.Loop())
+    {
+        Keep(env.Feed(vecArgs));
+    }
+}
+
+DEF_BENCH(read_config, 100, 1000, 10000)
+{
+    const char* pFile = "/tmp/bench-cliop-config.ini";
+    {
+        std::ofstream fout(pFile);
+        fout << "# generated config\n";
+        for (int i = 0; i < state.Param(); ++i)
+        {
+            if (i % 50 == 0)
+            {
+                fout << "[group" << i / 50 << "]\n";
+            }
+            fout << "key" << i << " = \"value " << i << "\"\n";
+        }
+    }
+    cli::CEnvBase env;
+    std::shared_ptr<const cli::CEnvSpec> pSpec = env.Share();
+    cli::CParseContext ctx(pSpec);
+    while (state.Loop())
+    {
+        ctx.ClearArgument();
+        Keep(ctx.FeedConfig(pFile));
+    }
+    remove(pFile);
+}
+
+namespace
+{
+
+/** Write config of `nLine` lines, half options and half arguments. */
+void WriteStartupConfig(const char* pFile, int nLine)
+{
+    std::ofstream fout(pFile);
+    fout << "name = lym\n-v\n[group]\n";
+    for (int i = 0; i < nLine / 2; ++i)
+    {
+        fout << "key" << i << " = \"value " << i << "\"\n";
+    }
+    fout << "[--]\n";
+    for (int i = 0; i < nLine / 2; ++i)
+    {
+        fout << "file-" << i << ".txt\n";
+    }
+}
+
+/** Startup with new object and feed the config, use cache file if given. */
+int StartupConfig(const char* argv[], const char* pCache)
+{
+    cli::CEnvBase env;
+    env.Set("--name=", "user name").Flag('v', "verbose", "print more");
+    if (pCache != nullptr)
+    {
+        env.ConfigCache(pCache);
+    }
+    env.Feed(2, argv);
+    return env.Argc();
+}
+
+const char* s_pStartupConfig = "/tmp/bench-cliop-startup.ini";
+const char* s_pStartupCache = "/tmp/bench-cliop-startup.cache";
+
+} // namespace
+
+DEF_BENCH(config_startup, 100, 1000, 10000)
+{
+    WriteStartupConfig(s_pStartupConfig, state.Param());
+    std::string strConfig = std::string("--config=") + s_pStartupConfig;
+    const char* argv[] = {"bench", strConfig.c_str(), nullptr};
+    while (state.Loop())
+    {
+        Keep(StartupConfig(argv, nullptr));
+    }
+    remove(s_pStartupConfig);
+}
+
+// cache file is removed before each startup, parse and write cache again
+DEF_BENCH(config_cache_cold, 100, 1000, 10000)
+{
+    WriteStartupConfig(s_pStartupConfig, state.Param());
+    std::string strConfig = std::string("--config=") + s_pStartupConfig;
+    const char* argv[] = {"bench", strConfig.c_str(), nullptr};
+    while (state.Loop())
+    {
+        remove(s_pStartupCache);
+        Keep(StartupConfig(argv, s_pStartupCache));
+    }
+    remove(s_pStartupConfig);
+    remove(s_pStartupCache);
+}
+
+DEF_BENCH(config_cache_warm, 100, 1000, 10000)
+{
+    WriteStartupConfig(s_pStartupConfig, state.Param());
+    std::string strConfig = std::string("--config=") + s_pStartupConfig;
+    const char* argv[] = {"bench", strConfig.c_str(), nullptr};
+    remove(s_pStartupCache);
+    StartupConfig(argv, s_pStartupCache);
+    while (state.Loop())
+    {
+        Keep(StartupConfig(argv, s_pStartupCache));
+    }
+    remove(s_pStartupConfig);
+    remove(s_pStartupCache);
+}
+
+namespace
+{
+
+/** Job file like options for batch, all env set the same. */
+void BatchSpec(cli::CEnvBase& env)
+{
+    env.Set("#1 --input=", "input file").Set("-c --count= [1]", "count")
+        .Set("-e --expr=+", "repeated expression").Set("--user=", "user name")
+        .Flag('v', "verbose", "print more").Set("--config= [NONE]", "no config");
+}
+
+std::vector<std::string> BatchLines(int nLine)
+{
+    std::vector<std::string> vecLines;
+    for (int i = 0; i < nLine; ++i)
+    {
+        vecLines.push_back("input-" + std::to_string(i) + ".txt -c " + std::to_string(i % 100)
+                + " -e first -e second --user=u" + std::to_string(i % 7) + " -v out-" + std::to_string(i));
+    }
+    return vecLines;
+}
+
+} // namespace
+
+// parse `Param` lines per op, each with a new object, as a process per line
+DEF_BENCH(batch_line_new, 100, 1000)
+{
+    std::vector<std::string> vecLines = BatchLines(state.Param());
+    std::vector<std::string> vecArgs;
+    while (state.Loop())
+    {
+        for (const std::string& strLine : vecLines)
+        {
+            cli::CEnvBase env;
+            BatchSpec(env);
+            vecArgs.clear();
+            util::SplitBySpace(strLine, vecArgs);
+            env.Feed(vecArgs);
+            Keep(env.Get("count").size());
+        }
+    }
+}
+
+// parse `Param` lines per op, feed each line to the same object
+DEF_BENCH(batch_line_reuse, 100, 1000)
+{
+    std::vector<std::string> vecLines = BatchLines(state.Param());
+    cli::CEnvBase env;
+    BatchSpec(env);
+    std::vector<std::string> vecArgs;
+    while (state.Loop())
+    {
+        for (const std::string& strLine : vecLines)
+        {
+            vecArgs.clear();
+            util::SplitBySpace(strLine, vecArgs);
+            env.ClearArgument();
+            env.Feed(vecArgs);
+            Keep(env.Get("count").size());
+        }
+    }
+}
+
+// parse `Param` lines per op by FeedBatch() into columns
+DEF_BENCH(feed_batch, 100, 1000)
+{
+    std::vector<std::string> vecLines = BatchLines(state.Param());
+    cli::CEnvBase env;
+    BatchSpec(env);
+    cli::CBatchResult stResult;
+    while (state.Loop())
+    {
+        stResult.Clear();
+        env.FeedBatch(vecLines, stResult);
+        int iCount = stResult.OptionId("count");
+        for (size_t i = 0; i < stResult.Lines(); ++i)
+        {
+            Keep(stResult.Get(i, iCount).size());
+        }
+    }
+}
+
+DEF_BENCH(usage, 10, 100, 500)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(state.Param());
+    cli::CEnvBase env;
+    env.Command("bench", "benchmark usage text");
+    MakeSpec(env, vecOption);
+    std::string strText;
+    while (state.Loop())
+    {
+        strText.clear();
+        env.Usage(strText);
+        Keep(strText.size());
+    }
+}
+
+DEF_BENCH(subcommand, 10, 100, 1000)
+{
+    cli::CEnvBase env;
+    env.Set("--config= [NONE]", "no config");
+    int nCalled = 0;
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        env.SubCommand("command-" + std::to_string(i), "generated sub-command",
+                [&nCalled](int, const char*[], cli::CEnvBase*) { nCalled++; return 0; });
+    }
+    std::string strCommand = "command-" + std::to_string(state.Param() - 1);
+    std::vector<std::string> vecArgs = {strCommand, "-x", "file"};
+    std::vector<const char*> vecArgv = MakeArgv(vecArgs);
+    while (state.Loop())
+    {
+        Keep(env.Feed(vecArgv.size() - 1, vecArgv.data()));
+    }
+    Keep(nCalled);
+}
+
+DEF_BENCH(subcommand_multicall, 10, 100, 400, 1000)
+{
+    // busybox style, invoked through symlink named as the last sub-command
+    cli::CEnvBase env;
+    env.Set("--config= [NONE]", "no config");
+    int nCalled = 0;
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        env.SubCommand("command-" + std::to_string(i), "generated sub-command",
+                [&nCalled](int, const char*[], cli::CEnvBase*) { nCalled++; return 0; });
+    }
+    std::string strProgram = "/usr/local/bin/command-" + std::to_string(state.Param() - 1);
+    const char* argv[] = {strProgram.c_str(), "-x", "file", nullptr};
+    while (state.Loop())
+    {
+        Keep(env.Feed(3, argv));
+    }
+    Keep(nCalled);
+}
+
+namespace
+{
+
+/** Sub-command with dozens of options built in constructor. */
+struct CSubEnv : public cli::CEnvBase
+{
+    CSubEnv()
+    {
+        static const std::vector<bench::CSpecOption> s_vecOption = bench::MakeSpecOptions(24);
+        bench::MakeSpec(*this, s_vecOption);
+    }
+};
+
+/** Build a command tree with `nCommand` sub-commands, dispatch to the last. */
+int StartupTree(int nCommand, bool bLazy)
+{
+    cli::CEnvBase env;
+    env.Set("--config= [NONE]", "no config");
+    std::vector<std::unique_ptr<CSubEnv>> vecEager;
+    for (int i = 0; i < nCommand; ++i)
+    {
+        std::string strName = "command-" + std::to_string(i);
+        if (bLazy)
+        {
+            env.SubCommand<CSubEnv>(strName, "generated sub-command");
+        }
+        else
+        {
+            vecEager.emplace_back(new CSubEnv());
+            env.SubCommand(strName, "generated sub-command", *vecEager.back());
+        }
+    }
+    std::string strCommand = "command-" + std::to_string(nCommand - 1);
+    const char* argv[] = {"bench", strCommand.c_str(), "--g0.w0=1", nullptr};
+    return env.Feed(3, argv);
+}
+
+} // namespace
+
+DEF_BENCH(startup_eager, 10, 100, 400)
+{
+    while (state.Loop())
+    {
+        Keep(StartupTree(state.Param(), false));
+    }
+}
+
+DEF_BENCH(startup_lazy, 10, 100, 400)
+{
+    while (state.Loop())
+    {
+        Keep(StartupTree(state.Param(), true));
+    }
+}
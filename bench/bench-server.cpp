@@ -0,0 +1,84 @@
+/**
+ * @file bench-server.cpp
+ * @author lymslive
+ * @date 2022-05-14
+ * @brief Benchmark latency of invoking a command: spawn a new process, or
+ * call the command server through unix socket.
+ * */
+#include "bench.h"
+#include "cliop-server.h"
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <thread>
+
+extern char** environ;
+
+namespace
+{
+
+/** Command tree with `nCommand` sub-commands, as the tool run by server. */
+std::unique_ptr<cli::CEnvBase> ServerTree(int nCommand)
+{
+    std::unique_ptr<cli::CEnvBase> pEnv(new cli::CEnvBase());
+    pEnv->Set("--config= [NONE]", "no config");
+    for (int i = 0; i < nCommand; ++i)
+    {
+        pEnv->SubCommand("command-" + std::to_string(i), "generated sub-command",
+                [](int argc, const char*[], cli::CEnvBase*) { return argc; });
+    }
+    return pEnv;
+}
+
+} // namespace
+
+// process startup of this benchmark itself, which only parse the cmdline
+// and print nothing, the lower bound of running any small tool
+DEF_BENCH(invoke_spawn, 1)
+{
+    int fdNull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    posix_spawn_file_actions_t stActions;
+    posix_spawn_file_actions_init(&stActions);
+    posix_spawn_file_actions_adddup2(&stActions, fdNull, 1);
+    posix_spawn_file_actions_adddup2(&stActions, fdNull, 2);
+    const char* argv[] = {"bench-cliop", "--list", "--filter=@none", nullptr};
+    while (state.Loop())
+    {
+        pid_t pid = 0;
+        int iStatus = 0;
+        if (posix_spawn(&pid, "/proc/self/exe", &stActions, nullptr, const_cast<char**>(argv), environ) == 0)
+        {
+            waitpid(pid, &iStatus, 0);
+        }
+        bench::Keep(iStatus);
+    }
+    posix_spawn_file_actions_destroy(&stActions);
+    close(fdNull);
+}
+
+// the server build the command tree with `Param` sub-commands per request
+DEF_BENCH(invoke_server, 1, 10, 100)
+{
+    std::string strPath = "/tmp/bench-cliop-" + std::to_string(getpid()) + ".sock";
+    int nCommand = state.Param();
+    cli::CCommandServer server([nCommand]() { return ServerTree(nCommand); });
+    if (server.Listen(strPath) != 0)
+    {
+        while (state.Loop()) {}
+        return;
+    }
+    std::thread thServer([&server]() { server.Serve(); });
+
+    int fdNull = open("/dev/null", O_RDWR | O_CLOEXEC);
+    std::string strCommand = "command-" + std::to_string(nCommand - 1);
+    const char* argv[] = {"bench-cliop", strCommand.c_str(), "-x", "file", nullptr};
+    while (state.Loop())
+    {
+        bench::Keep(cli::CallServer(strPath, 4, argv, fdNull, fdNull, fdNull));
+    }
+
+    server.Stop();
+    thServer.join();
+    close(fdNull);
+}
@@ -0,0 +1,43 @@
+/**
+ * @file bench-spec.h
+ * @author lymslive
+ * @date 2022-05-08
+ * @brief Generate option setup and cmdline for benchmark, shared by cases.
+ * */
+#ifndef BENCH_SPEC_H__
+#define BENCH_SPEC_H__
+
+#include "cliop.h"
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+/** Generated option, modeled on large real tools such as compiler or media
+ * converter, with dotted group names, flags, short names and defaults.
+ * */
+struct CSpecOption
+{
+    char m_cShortName = '\0';
+    std::string m_strLongName;
+    bool m_bFlag = false;
+    bool m_bRepeated = false;
+    std::string m_strDefault;
+};
+
+/** Generate `nOption` options, the same for the same count. */
+std::vector<CSpecOption> MakeSpecOptions(int nOption);
+
+/** Add the generated options to env, and --config=NONE. */
+void MakeSpec(cli::CEnvBase& env, const std::vector<CSpecOption>& vecOption);
+
+/** Generate cmdline that use `nUse` options spread in the setup. */
+std::vector<std::string> MakeCmdline(const std::vector<CSpecOption>& vecOption, int nUse);
+
+/** Make argv from cmdline, with argv[0] and null end, refer to the strings. */
+std::vector<const char*> MakeArgv(const std::vector<std::string>& vecArgs);
+
+} /* bench */
+
+#endif /* end of include guard: BENCH_SPEC_H__ */
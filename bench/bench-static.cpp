@@ -0,0 +1,55 @@
+/**
+ * @file bench-static.cpp
+ * @author lymslive
+ * @date 2022-05-20
+ * @brief Benchmark startup of option table declared at compile time, compare
+ * with the same options added one by one at runtime.
+ * */
+#include "bench.h"
+#include "cliop-static.h"
+
+namespace
+{
+
+#define DECL_OPTION(i) {'\0', "option.name." #i, "generated option"}
+#define DECL_OPTION8(i) DECL_OPTION(i##0), DECL_OPTION(i##1), DECL_OPTION(i##2), DECL_OPTION(i##3), \
+    DECL_OPTION(i##4), DECL_OPTION(i##5), DECL_OPTION(i##6), DECL_OPTION(i##7)
+
+struct CManyOption
+{
+    static constexpr cli::COptionDecl value[] = {
+        DECL_OPTION8(1), DECL_OPTION8(2), DECL_OPTION8(3), DECL_OPTION8(4),
+        DECL_OPTION8(5), DECL_OPTION8(6), DECL_OPTION8(7), DECL_OPTION8(8),
+    };
+};
+constexpr cli::COptionDecl CManyOption::value[];
+
+const char* s_argvStatic[] = {"static", "--option.name.42=42", "--config=NONE", nullptr};
+
+} // namespace
+
+// setup the 64 options by Option() and feed, as program startup
+DEF_BENCH(static_runtime, 64)
+{
+    const cli::CPerfectIndex& stMany = cli::StaticSpec<CManyOption>();
+    while (state.Loop())
+    {
+        cli::CEnvBase env;
+        for (size_t k = 0; k < stMany.m_nDecl; ++k)
+        {
+            env.Option('\0', stMany.m_pDecl[k].m_pLongName, stMany.m_pDecl[k].m_pDescription);
+        }
+        bench::Keep(env.Feed(3, s_argvStatic));
+    }
+}
+
+// setup the same options by Declare() and feed
+DEF_BENCH(static_declare, 64)
+{
+    while (state.Loop())
+    {
+        cli::CEnvBase env;
+        env.Declare(cli::StaticSpec<CManyOption>());
+        bench::Keep(env.Feed(3, s_argvStatic));
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file bench-thread.cpp
+ * @author lymslive
+ * @date 2022-05-16
+ * @brief Benchmark cases of parse in multiple threads: feed with shared
+ * option setup while other threads also feed, and read published snapshot.
+ * */
+#include "bench.h"
+#include "cliop.h"
+#include <atomic>
+#include <thread>
+
+namespace
+{
+
+/** Option setup shared by all threads, without bound variable. */
+std::shared_ptr<const cli::CEnvSpec> ThreadSpec(cli::CEnvBase& env)
+{
+    env.Flag('v', "verbose", "print more")
+        .Option('n', "number", "the number of thread", "1")
+        .Set("-e --expr=+", "repeated expression")
+        .Set("#1 --input=", "input file")
+        .Set("--user=?", "required user name")
+        .Set("--config= [NONE]", "no config");
+    return env.Share();
+}
+
+const char* s_argvThread[] = {"thread", "in.txt", "-v", "-n", "42", "-e", "first", "-e", "last",
+    "--user=me", nullptr};
+const int s_argcThread = sizeof(s_argvThread) / sizeof(s_argvThread[0]) - 1;
+
+} // namespace
+
+// latency of one feed while `Param - 1` other threads keep feeding with the
+// same setup, flat if the shared setup has no contention
+DEF_BENCH(thread_feed, 1, 2, 4, 8)
+{
+    cli::CEnvBase env;
+    auto pSpec = ThreadSpec(env);
+    std::atomic<bool> bStop(false);
+    std::vector<std::thread> vecThread;
+    for (int i = 1; i < state.Param(); ++i)
+    {
+        vecThread.emplace_back([pSpec, &bStop]()
+        {
+            cli::CParseContext ctx(pSpec);
+            while (!bStop)
+            {
+                bench::Keep(ctx.Feed(s_argcThread, s_argvThread));
+            }
+        });
+    }
+
+    cli::CParseContext ctx(pSpec);
+    while (state.Loop())
+    {
+        bench::Keep(ctx.Feed(s_argcThread, s_argvThread));
+    }
+    bStop = true;
+    for (auto& th : vecThread)
+    {
+        th.join();
+    }
+}
+
+// read current snapshot when not changed, as reader thread does
+DEF_BENCH(snapshot_read, 1)
+{
+    cli::CEnvBase env;
+    env.Set("--alpha=", "the first value").Set("--config= [NONE]", "no config").PublishSnapshot();
+    env.Feed({"--alpha=1"});
+    cli::CSnapshotReader stReader(env.Publisher());
+    size_t nSum = 0;
+    while (state.Loop())
+    {
+        nSum += stReader.Current()->Get("alpha").size();
+    }
+    bench::Keep(nSum);
+}
@@ -0,0 +1,195 @@
+/**
+ * @file bench-util.cpp
+ * @author lymslive
+ * @date 2022-05-08
+ * @brief Benchmark cases of string utilities, and getopt_long() as baseline
+ * to compare with the `feed_option` case.
+ * */
+#include "bench.h"
+#include "bench-spec.h"
+#include "util-string.h"
+#include <getopt.h>
+#include <stdlib.h>
+
+using namespace bench;
+
+DEF_BENCH(util_split, 10, 100, 1000)
+{
+    std::string strSrc;
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        strSrc.append("item").append(std::to_string(i)).append(",");
+    }
+    std::vector<std::string> vecDest;
+    while (state.Loop())
+    {
+        vecDest.clear();
+        Keep(util::Split(strSrc, vecDest, ','));
+    }
+}
+
+DEF_BENCH(util_split_space, 10, 100, 1000)
+{
+    std::string strSrc;
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        strSrc.append("  item").append(std::to_string(i));
+    }
+    std::vector<std::string> vecDest;
+    while (state.Loop())
+    {
+        vecDest.clear();
+        Keep(util::SplitBySpace(strSrc, vecDest));
+    }
+}
+
+DEF_BENCH(util_split_number, 10, 100, 1000)
+{
+    std::string strSrc;
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        strSrc.append(std::to_string(i * 37)).append(",");
+    }
+    std::vector<int> vecDest;
+    while (state.Loop())
+    {
+        vecDest.clear();
+        Keep(util::SplitNumber(strSrc, vecDest, ','));
+    }
+}
+
+// baseline of util_split_number, split to strings then atoi()
+DEF_BENCH(util_split_atoi, 10, 100, 1000)
+{
+    std::string strSrc;
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        strSrc.append(std::to_string(i * 37)).append(",");
+    }
+    std::vector<std::string> vecItem;
+    std::vector<int> vecDest;
+    while (state.Loop())
+    {
+        vecItem.clear();
+        vecDest.clear();
+        util::Split(strSrc, vecItem, ',');
+        for (const std::string& strItem : vecItem)
+        {
+            vecDest.push_back(atoi(strItem.c_str()));
+        }
+        Keep(vecDest.size());
+    }
+}
+
+namespace
+{
+
+const std::vector<std::string> s_vecInt = {"0", "7", "42", "-1024", "65535", "1234567", "-2147483647", "99"};
+const std::vector<std::string> s_vecDouble = {"0.5", "3.14159", "-2.5e3", "1e-5", "123456.789", "0.001", "42", "6.02e23"};
+
+} // namespace
+
+// parse one integer per op, from a few samples of different length
+DEF_BENCH(util_parse_int, 1)
+{
+    size_t i = 0;
+    while (state.Loop())
+    {
+        int iVal = 0;
+        util::ParseNumber(s_vecInt[i++ % s_vecInt.size()], iVal);
+        Keep(iVal);
+    }
+}
+
+DEF_BENCH(util_atoi, 1)
+{
+    size_t i = 0;
+    while (state.Loop())
+    {
+        Keep(atoi(s_vecInt[i++ % s_vecInt.size()].c_str()));
+    }
+}
+
+DEF_BENCH(util_parse_double, 1)
+{
+    size_t i = 0;
+    while (state.Loop())
+    {
+        double fVal = 0;
+        util::ParseNumber(s_vecDouble[i++ % s_vecDouble.size()], fVal);
+        Keep(fVal);
+    }
+}
+
+DEF_BENCH(util_atof, 1)
+{
+    size_t i = 0;
+    while (state.Loop())
+    {
+        Keep(atof(s_vecDouble[i++ % s_vecDouble.size()].c_str()));
+    }
+}
+
+DEF_BENCH(util_text_align, 10, 100, 1000)
+{
+    std::vector<std::vector<std::string>> vecRows;
+    for (int i = 0; i < state.Param(); ++i)
+    {
+        vecRows.push_back({"--option-name-" + std::to_string(i), "<value>",
+                "description text of the option " + std::to_string(i)});
+    }
+    while (state.Loop())
+    {
+        util::CTextAlign stAlign;
+        for (const std::vector<std::string>& vecRow : vecRows)
+        {
+            std::vector<std::string> vecLine = vecRow;
+            stAlign.AddLine(vecLine);
+        }
+        Keep(stAlign.GetText().size());
+    }
+}
+
+DEF_BENCH(getopt_long, 10, 100, 500, 1000)
+{
+    std::vector<CSpecOption> vecOption = MakeSpecOptions(state.Param());
+    std::vector<struct option> vecLong;
+    std::string strShort;
+    for (size_t i = 0; i < vecOption.size(); ++i)
+    {
+        const CSpecOption& stOption = vecOption[i];
+        struct option stLong = {stOption.m_strLongName.c_str(),
+            stOption.m_bFlag ? no_argument : required_argument, nullptr, static_cast<int>(256 + i)};
+        vecLong.push_back(stLong);
+        if (stOption.m_cShortName != '\0')
+        {
+            strShort.push_back(stOption.m_cShortName);
+            if (!stOption.m_bFlag)
+            {
+                strShort.push_back(':');
+            }
+        }
+    }
+    vecLong.push_back(option{nullptr, 0, nullptr, 0});
+
+    std::vector<std::string> vecArgs = MakeCmdline(vecOption, 20);
+    std::vector<const char*> vecArgv = MakeArgv(vecArgs);
+    std::vector<char*> vecCopy(vecArgv.size());
+    opterr = 0;
+    while (state.Loop())
+    {
+        // getopt_long() permutes argv
+        for (size_t i = 0; i < vecArgv.size(); ++i)
+        {
+            vecCopy[i] = const_cast<char*>(vecArgv[i]);
+        }
+        optind = 0;
+        int nOption = 0;
+        int iIndex = 0;
+        while (getopt_long(vecCopy.size() - 1, vecCopy.data(), strShort.c_str(), vecLong.data(), &iIndex) != -1)
+        {
+            nOption++;
+        }
+        Keep(nOption);
+    }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file bench.h
+ * @author lymslive
+ * @date 2022-05-08
+ * @brief Minimal micro-benchmark harness, without external dependency.
+ * @details Usage:
+ * @code
+ * DEF_BENCH(feed_option, 10, 100, 500)
+ * {
+ *     // setup not timed, state.Param() is one of 10, 100, 500
+ *     while (state.Loop())
+ *     {
+ *         // timed code
+ *     }
+ * }
+ * @endcode
+ * Each case is run with increasing iterations until the minimal time is
+ * reached, then report ns/op and heap allocations/op.
+ * */
+#ifndef BENCH_H__
+#define BENCH_H__
+
+#include "alloc-hook.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <initializer_list>
+#include <chrono>
+
+namespace bench
+{
+
+/** State of one benchmark run, loop on `while (state.Loop())`. */
+class CState
+{
+    int m_iParam = 0;             //< scenario parameter
+    size_t m_nIter = 0;           //< iterations to run
+    size_t m_nDone = 0;           //< iterations already run
+    std::chrono::steady_clock::time_point m_tBegin;
+    std::chrono::steady_clock::time_point m_tEnd;
+    uint64_t m_nAllocBegin = 0;
+    uint64_t m_nAllocEnd = 0;
+
+public:
+    CState(int iParam, size_t nIter) : m_iParam(iParam), m_nIter(nIter) {}
+
+    /** The parameter of scenario, such as option count. */
+    int Param() const { return m_iParam; }
+
+    /** Start timing on the first call, and stop after the last iteration. */
+    bool Loop()
+    {
+        if (m_nDone == 0)
+        {
+            m_nAllocBegin = AllocCount();
+            m_tBegin = std::chrono::steady_clock::now();
+        }
+        if (m_nDone++ < m_nIter)
+        {
+            return true;
+        }
+        m_tEnd = std::chrono::steady_clock::now();
+        m_nAllocEnd = AllocCount();
+        return false;
+    }
+
+    size_t Iterations() const { return m_nIter; }
+    double Nanoseconds() const { return std::chrono::duration<double, std::nano>(m_tEnd - m_tBegin).count(); }
+    uint64_t Allocations() const { return m_nAllocEnd - m_nAllocBegin; }
+};
+
+typedef void (*FBench)(CState& state);
+
+/** Register a benchmark case with its parameters, return count of cases. */
+int Register(const char* pName, std::initializer_list<int> listParam, FBench fn);
+
+/** Keep the value computed, not optimized away by compiler. */
+template <typename valueT>
+inline void Keep(const valueT& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} /* bench */
+
+/** Define a benchmark case, run once for each parameter. */
+#define DEF_BENCH(name, ...) \
+    static void bench_##name(bench::CState& state); \
+    static int s_bench_##name = bench::Register(#name, {__VA_ARGS__}, bench_##name); \
+    static void bench_##name(bench::CState& state)
+
+#endif /* end of include guard: BENCH_H__ */
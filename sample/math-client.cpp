@@ -0,0 +1,23 @@
+/**
+ * @file math-client.cpp
+ * @author lymslive
+ * @date 2022-05-14
+ * @brief Expample to forward command line to math-server
+ * @details The socket path is from environment variable CLIOP_MATH_SOCKET,
+ * or the default one of math-server. Output is printed by the server to the
+ * stdout of this client directly.
+ * */
+#include "cliop-server.h"
+
+int main(int argc, char* argv[])
+{
+    const char* pSocket = getenv("CLIOP_MATH_SOCKET");
+    std::string strSocket = pSocket != nullptr ? pSocket : "/tmp/cliop-math.sock";
+    int nRet = cli::CallServer(strSocket, argc, const_cast<const char**>(argv));
+    if (nRet < 0)
+    {
+        fprintf(stderr, "can't call math-server on %s\n", strSocket.c_str());
+        return 1;
+    }
+    return nRet == cli::ERROR_CODE_HELP ? 0 : nRet;
+}
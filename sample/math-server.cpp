@@ -0,0 +1,91 @@
+/**
+ * @file math-server.cpp
+ * @author lymslive
+ * @date 2022-05-14
+ * @brief Expample to serve sub-command in persistent process
+ * @details The same math command, but run in server, call by math-client:
+ * ./math-server --socket=/tmp/cliop-math.sock &
+ * ./math-client add 2 3
+ * ./math-client mul 2 3
+ * */
+#include "cliop-server.h"
+#include <signal.h>
+
+namespace math
+{
+
+int add(int argc, const char* argv[], cli::CEnvBase* args)
+{
+    int a = atoi(args->Get(1).c_str());
+    int b = atoi(args->Get(2).c_str());
+    printf("%d\n", a + b);
+    return 0;
+}
+
+struct CMul : public cli::CEnvBase
+{
+    int left = 0;
+    int right = 0;
+
+    CMul()
+    {
+        Set("-l #1 --left=?", "left operand", left);
+        Set("-r #2 --right=?", "right operand", right);
+    }
+
+    virtual int Run(int argc, const char* argv[]) override
+    {
+        printf("%d\n", left * right);
+        return 0;
+    }
+};
+
+// create the command for each request, so nothing left from last request
+std::unique_ptr<cli::CEnvBase> Create()
+{
+    std::unique_ptr<cli::CEnvBase> pEnv(new cli::CEnvBase());
+    pEnv->Command("math", "basic math opertion")
+        .SubCommand("add", "as operator+", add)
+        .SubCommand<CMul>("mul", "as operator*");
+    return pEnv;
+}
+
+cli::CCommandServer* s_pServer = nullptr;
+
+void OnSignal(int iSignal)
+{
+    if (s_pServer != nullptr)
+    {
+        s_pServer->Stop();
+    }
+}
+
+} // math
+
+int main(int argc, char* argv[])
+{
+    std::string strSocket;
+    cli::CEnvBase env;
+    env.Command("math-server", "serve math command for math-client");
+    env.Set("--socket= [/tmp/cliop-math.sock]", "unix socket path to listen", strSocket);
+    int nRet = env.Feed(argc, argv);
+    if (nRet != 0)
+    {
+        return nRet == cli::ERROR_CODE_HELP ? 0 : nRet;
+    }
+
+    cli::CCommandServer server(math::Create);
+    int nError = server.Listen(strSocket);
+    if (nError != 0)
+    {
+        fprintf(stderr, "can't listen on %s: %s\n", strSocket.c_str(), strerror(nError));
+        return 1;
+    }
+
+    math::s_pServer = &server;
+    signal(SIGINT, math::OnSignal);
+    signal(SIGTERM, math::OnSignal);
+    server.Serve();
+    math::s_pServer = nullptr;
+    return 0;
+}
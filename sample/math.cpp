@@ -57,11 +57,11 @@ struct CMul : public cli::CEnvBase
 
 int main(int argc, char* argv[])
 {
-    math::CMul mulEnv;
+    // way 3: CMul is only created when `mul` is dispatched
     cli::CEnvBase env;
     env.Command("math", "basic math opertion")
         .SubCommand("add", "as operator+", math::add)
-        .SubCommand("mul", "as operator*", mulEnv);
+        .SubCommand<math::CMul>("mul", "as operator*");
     return env.Feed(argc, argv);
 }
 
@@ -0,0 +1,357 @@
+#include "cliop-server.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+namespace cli
+{
+
+/// request: uint32 size of payload, then payload of uint32 argc and each
+/// argument as uint32 size and bytes; stdin, stdout, stderr are passed in
+/// SCM_RIGHTS with the first bytes. reply: int32 exit code.
+static const uint32_t REQUEST_SIZE_MAX = 64 << 20;
+static const int STDIO_COUNT = 3;
+
+static bool SetAddress(const std::string& strPath, struct sockaddr_un& stAddr)
+{
+    memset(&stAddr, 0, sizeof(stAddr));
+    stAddr.sun_family = AF_UNIX;
+    if (strPath.empty() || strPath.size() >= sizeof(stAddr.sun_path))
+    {
+        return false;
+    }
+    memcpy(stAddr.sun_path, strPath.data(), strPath.size());
+    return true;
+}
+
+static bool ReadAll(int fd, char* pBuffer, size_t nSize)
+{
+    while (nSize > 0)
+    {
+        ssize_t nRead = read(fd, pBuffer, nSize);
+        if (nRead < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (nRead <= 0)
+        {
+            return false;
+        }
+        pBuffer += nRead;
+        nSize -= nRead;
+    }
+    return true;
+}
+
+static bool SendAll(int fd, const char* pBuffer, size_t nSize)
+{
+    while (nSize > 0)
+    {
+        ssize_t nSent = send(fd, pBuffer, nSize, MSG_NOSIGNAL);
+        if (nSent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (nSent <= 0)
+        {
+            return false;
+        }
+        pBuffer += nSent;
+        nSize -= nSent;
+    }
+    return true;
+}
+
+static void AppendSize(std::string& strDest, uint32_t uSize)
+{
+    strDest.append(reinterpret_cast<const char*>(&uSize), sizeof(uSize));
+}
+
+static bool ReadSize(util::CStrView& strSrc, uint32_t& uSize)
+{
+    if (strSrc.size() < sizeof(uSize))
+    {
+        return false;
+    }
+    memcpy(&uSize, strSrc.data(), sizeof(uSize));
+    strSrc = strSrc.substr(sizeof(uSize));
+    return true;
+}
+
+CCommandServer::CCommandServer(FCommandFactory fnFactory)
+    : m_fnFactory(fnFactory), m_bStop(false)
+{
+}
+
+CCommandServer::~CCommandServer()
+{
+    Close();
+    for (int i = 0; i < STDIO_COUNT; ++i)
+    {
+        if (m_aStdSaved[i] >= 0)
+        {
+            close(m_aStdSaved[i]);
+        }
+    }
+}
+
+int CCommandServer::Listen(const std::string& strPath)
+{
+    struct sockaddr_un stAddr;
+    if (!SetAddress(strPath, stAddr))
+    {
+        return ENAMETOOLONG;
+    }
+
+    Close();
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return errno;
+    }
+    unlink(strPath.c_str());
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&stAddr), sizeof(stAddr)) != 0 || listen(fd, 64) != 0)
+    {
+        int nError = errno;
+        close(fd);
+        return nError;
+    }
+
+    m_fdListen = fd;
+    m_strPath = strPath;
+    m_bStop = false;
+    return 0;
+}
+
+int CCommandServer::Serve(int nRequest)
+{
+    for (int i = 0; nRequest < 0 || i < nRequest; ++i)
+    {
+        int fdClient = accept4(m_fdListen, nullptr, nullptr, SOCK_CLOEXEC);
+        if (m_bStop)
+        {
+            if (fdClient >= 0)
+            {
+                close(fdClient);
+            }
+            break;
+        }
+        if (fdClient < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            return errno;
+        }
+        Handle(fdClient);
+        close(fdClient);
+    }
+    return 0;
+}
+
+void CCommandServer::Stop()
+{
+    m_bStop = true;
+    if (m_fdListen >= 0)
+    {
+        // wake up the blocking accept()
+        shutdown(m_fdListen, SHUT_RDWR);
+    }
+}
+
+void CCommandServer::Close()
+{
+    if (m_fdListen >= 0)
+    {
+        close(m_fdListen);
+        m_fdListen = -1;
+        unlink(m_strPath.c_str());
+        m_strPath.clear();
+    }
+}
+
+int CCommandServer::Handle(int fdClient)
+{
+    // not wait forever for a slow client
+    if (m_iTimeoutMs > 0)
+    {
+        struct timeval stTimeout;
+        stTimeout.tv_sec = m_iTimeoutMs / 1000;
+        stTimeout.tv_usec = (m_iTimeoutMs % 1000) * 1000;
+        setsockopt(fdClient, SOL_SOCKET, SO_RCVTIMEO, &stTimeout, sizeof(stTimeout));
+        setsockopt(fdClient, SOL_SOCKET, SO_SNDTIMEO, &stTimeout, sizeof(stTimeout));
+    }
+
+    // the size header carries the stdio fds
+    uint32_t uSize = 0;
+    char aControl[CMSG_SPACE(sizeof(int) * STDIO_COUNT)];
+    struct iovec stIov = { &uSize, sizeof(uSize) };
+    struct msghdr stMsg;
+    memset(&stMsg, 0, sizeof(stMsg));
+    stMsg.msg_iov = &stIov;
+    stMsg.msg_iovlen = 1;
+    stMsg.msg_control = aControl;
+    stMsg.msg_controllen = sizeof(aControl);
+    ssize_t nRead = recvmsg(fdClient, &stMsg, MSG_CMSG_CLOEXEC);
+
+    int aStdio[STDIO_COUNT] = {-1, -1, -1};
+    int nStdio = 0;
+    for (struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&stMsg); pCmsg != nullptr; pCmsg = CMSG_NXTHDR(&stMsg, pCmsg))
+    {
+        if (pCmsg->cmsg_level != SOL_SOCKET || pCmsg->cmsg_type != SCM_RIGHTS)
+        {
+            continue;
+        }
+        int nFd = (pCmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const int* pFd = reinterpret_cast<const int*>(CMSG_DATA(pCmsg));
+        for (int i = 0; i < nFd; ++i)
+        {
+            if (nStdio < STDIO_COUNT)
+            {
+                aStdio[nStdio++] = pFd[i];
+            }
+            else
+            {
+                close(pFd[i]);
+            }
+        }
+    }
+
+    std::string strPayload;
+    bool bValid = nRead > 0 && nStdio == STDIO_COUNT
+        && ReadAll(fdClient, reinterpret_cast<char*>(&uSize) + nRead, sizeof(uSize) - nRead)
+        && uSize <= REQUEST_SIZE_MAX;
+    if (bValid)
+    {
+        strPayload.resize(uSize);
+        bValid = ReadAll(fdClient, &strPayload[0], uSize);
+    }
+
+    // argv refer to the payload
+    std::vector<const char*> vecArgv;
+    util::CStrView strSrc(strPayload);
+    uint32_t uArgc = 0;
+    bValid = bValid && ReadSize(strSrc, uArgc) && uArgc > 0 && uArgc <= uSize;
+    for (uint32_t i = 0; bValid && i < uArgc; ++i)
+    {
+        uint32_t uArg = 0;
+        bValid = ReadSize(strSrc, uArg) && uArg < strSrc.size() && strSrc[uArg] == '\0';
+        if (bValid)
+        {
+            vecArgv.push_back(strSrc.data());
+            strSrc = strSrc.substr(uArg + 1);
+        }
+    }
+    vecArgv.push_back(nullptr);
+
+    int nExit = -1;
+    if (bValid)
+    {
+        fflush(stdout);
+        fflush(stderr);
+        for (int i = 0; i < STDIO_COUNT; ++i)
+        {
+            if (m_aStdSaved[i] < 0)
+            {
+                m_aStdSaved[i] = fcntl(i, F_DUPFD_CLOEXEC, 0);
+            }
+            dup2(aStdio[i], i);
+        }
+
+        std::unique_ptr<CEnvBase> pEnv = m_fnFactory();
+        if (pEnv)
+        {
+            nExit = pEnv->Feed(static_cast<int>(uArgc), vecArgv.data());
+        }
+        pEnv.reset();
+
+        fflush(stdout);
+        fflush(stderr);
+        for (int i = 0; i < STDIO_COUNT; ++i)
+        {
+            if (m_aStdSaved[i] >= 0)
+            {
+                dup2(m_aStdSaved[i], i);
+            }
+        }
+        m_nServed++;
+    }
+
+    for (int i = 0; i < nStdio; ++i)
+    {
+        close(aStdio[i]);
+    }
+
+    int32_t iReply = nExit;
+    SendAll(fdClient, reinterpret_cast<const char*>(&iReply), sizeof(iReply));
+    return nExit;
+}
+
+int CallServer(const std::string& strPath, int argc, const char* argv[], int fdIn, int fdOut, int fdErr)
+{
+    struct sockaddr_un stAddr;
+    if (argc <= 0 || argv == nullptr || !SetAddress(strPath, stAddr))
+    {
+        return -1;
+    }
+
+    int nArgc = 0;
+    while (nArgc < argc && argv[nArgc] != nullptr)
+    {
+        nArgc++;
+    }
+    std::string strRequest;
+    AppendSize(strRequest, 0);
+    AppendSize(strRequest, nArgc);
+    for (int i = 0; i < nArgc; ++i)
+    {
+        uint32_t uArg = strlen(argv[i]);
+        AppendSize(strRequest, uArg);
+        strRequest.append(argv[i], uArg + 1);
+    }
+    uint32_t uSize = strRequest.size() - sizeof(uSize);
+    memcpy(&strRequest[0], &uSize, sizeof(uSize));
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&stAddr), sizeof(stAddr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    // stdio fds with the size header, then the payload
+    int aStdio[STDIO_COUNT] = {fdIn, fdOut, fdErr};
+    char aControl[CMSG_SPACE(sizeof(aStdio))];
+    memset(aControl, 0, sizeof(aControl));
+    struct iovec stIov = { &strRequest[0], sizeof(uSize) };
+    struct msghdr stMsg;
+    memset(&stMsg, 0, sizeof(stMsg));
+    stMsg.msg_iov = &stIov;
+    stMsg.msg_iovlen = 1;
+    stMsg.msg_control = aControl;
+    stMsg.msg_controllen = sizeof(aControl);
+    struct cmsghdr* pCmsg = CMSG_FIRSTHDR(&stMsg);
+    pCmsg->cmsg_level = SOL_SOCKET;
+    pCmsg->cmsg_type = SCM_RIGHTS;
+    pCmsg->cmsg_len = CMSG_LEN(sizeof(aStdio));
+    memcpy(CMSG_DATA(pCmsg), aStdio, sizeof(aStdio));
+
+    int32_t iReply = -1;
+    bool bDone = sendmsg(fd, &stMsg, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(uSize))
+        && SendAll(fd, strRequest.data() + sizeof(uSize), uSize)
+        && ReadAll(fd, reinterpret_cast<char*>(&iReply), sizeof(iReply));
+    close(fd);
+    return bDone ? iReply : -1;
+}
+
+} /* cli */
@@ -0,0 +1,93 @@
+/**
+ * @file cliop-server.h
+ * @author lymslive
+ * @date 2022-05-14
+ * @brief Serve commands in a persistent process over unix socket.
+ * @details The server create a fresh @ref CEnvBase by factory for each
+ * request, and Feed() it with the argv from client. The client pass its
+ * stdin, stdout and stderr by the socket, so the output of handler goes to
+ * the client directly, then the exit code is sent back. Usage:
+ * @code
+ * // server
+ * cli::CCommandServer server([]() { return std::unique_ptr<cli::CEnvBase>(new CMain()); });
+ * server.Listen("/tmp/tool.sock");
+ * server.Serve();
+ *
+ * // client, as main() of the tool
+ * return cli::CallServer("/tmp/tool.sock", argc, argv);
+ * @endcode
+ * */
+#ifndef CLIOP_SERVER_H__
+#define CLIOP_SERVER_H__
+
+#include "cliop.h"
+#include <atomic>
+
+namespace cli
+{
+
+/** Server to run commands for clients, one request at a time.
+ * @note The stdio of the process is redirected to the client while running
+ * a request, so requests are served in sequence, in the thread of Serve().
+ * @note Handler should not call exit(). The working directory and
+ * environment variables of the client are not passed.
+ * */
+class CCommandServer
+{
+    FCommandFactory m_fnFactory;       //< create command for each request
+    int m_fdListen = -1;               //< listening unix socket
+    std::string m_strPath;             //< socket path, removed when closed
+    std::atomic<bool> m_bStop;         //< stop the serving loop
+    int m_aStdSaved[3] = {-1, -1, -1}; //< saved stdio of this process
+    uint64_t m_nServed = 0;            //< count of requests served
+    int m_iTimeoutMs = 1000;           //< drop client that sends slower
+
+public:
+    explicit CCommandServer(FCommandFactory fnFactory);
+    ~CCommandServer();
+
+    CCommandServer(const CCommandServer&) = delete;
+    CCommandServer& operator=(const CCommandServer&) = delete;
+
+    /** Listen on unix socket path, remove the stale one first.
+     * @return int: 0 for success, or errno.
+     * */
+    int Listen(const std::string& strPath);
+
+    /** Accept and handle requests until Stop().
+     * @param [IN] nRequest: return after so many requests, -1 for no limit.
+     * @return int: 0 when stopped or served, or errno of accept.
+     * */
+    int Serve(int nRequest = -1);
+
+    /** Set the time to wait for each read and write of a request.
+     * @note Requests are served in sequence, so a client that connects but
+     * does not send its request in time is dropped, not to block others.
+     * */
+    void SetTimeout(int iMillisecond) { m_iTimeoutMs = iMillisecond; }
+
+    /** Stop Serve() from other thread or signal handler. */
+    void Stop();
+
+    /** Handle one request on connected socket, not closed.
+     * @return int: exit code sent to client, or -1 for bad request.
+     * */
+    int Handle(int fdClient);
+
+    /** Close listening socket and remove the path. */
+    void Close();
+
+    uint64_t Served() const { return m_nServed; }
+};
+
+/** Forward argv to the server, wait for the exit code.
+ * @param [IN] strPath: unix socket path the server listens on.
+ * @param [IN] fdIn fdOut fdErr: stdio of the command run in server.
+ * @return int: exit code of the command, or -1 if cannot call the server.
+ * */
+int CallServer(const std::string& strPath, int argc, const char* argv[],
+        int fdIn = 0, int fdOut = 1, int fdErr = 2);
+
+} /* cli */
+
+#endif /* end of include guard: CLIOP_SERVER_H__ */
@@ -0,0 +1,233 @@
+/**
+ * @file cliop-static.h
+ * @author lymslive
+ * @date 2022-04-25
+ * @brief declare option table at compile time, with perfect hash of names.
+ * @details Usage:
+ * @code
+ * struct CMainOption
+ * {
+ *     static constexpr cli::COptionDecl value[] = {
+ *         {'v', "verbose", "print more message", "", 0},
+ *         {'n', "number", "how many times", "1"},
+ *     };
+ * };
+ * constexpr cli::COptionDecl CMainOption::value[];
+ *
+ * cli::CEnvBase env;
+ * env.Declare(cli::StaticSpec<CMainOption>()).Bind("number", number);
+ * @endcode
+ * Redefined or invalid option name is reported by static_assert.
+ * */
+#ifndef CLIOP_STATIC_H__
+#define CLIOP_STATIC_H__
+
+#include "cliop.h"
+
+namespace cli
+{
+
+/** Compile time check and hash for an array of @ref COptionDecl. */
+struct CStaticDecl
+{
+    /** Seed value when no perfect hash found. */
+    static constexpr uint32_t SEED_NONE = 0xFFFFFFFFu;
+    /** Seeds to try for each slot count. */
+    static constexpr uint32_t SEED_LIMIT = 4096;
+
+    static constexpr bool Equal(const char* pLeft, const char* pRight)
+    {
+        return *pLeft == *pRight && (*pLeft == '\0' || Equal(pLeft + 1, pRight + 1));
+    }
+
+    static constexpr bool HasChar(const char* pName, char c)
+    {
+        return *pName != '\0' && (*pName == c || HasChar(pName + 1, c));
+    }
+
+    /** The same rule as ERROR_CODE_OPTION_INVALID and ERROR_CODE_FLAG_INVALID. */
+    static constexpr bool Invalid(const COptionDecl& stDecl)
+    {
+        return stDecl.m_pLongName[0] == '\0' || stDecl.m_pLongName[0] == '-'
+            || HasChar(stDecl.m_pLongName, '=')
+            || !(stDecl.m_cShortName == '\0'
+                    || (stDecl.m_cShortName >= 'a' && stDecl.m_cShortName <= 'z')
+                    || (stDecl.m_cShortName >= 'A' && stDecl.m_cShortName <= 'Z'));
+    }
+
+    static constexpr bool AnyInvalid(const COptionDecl* pDecl, size_t iBegin, size_t iEnd)
+    {
+        return iEnd - iBegin == 1 ? Invalid(pDecl[iBegin])
+            : AnyInvalid(pDecl, iBegin, (iBegin + iEnd) / 2) || AnyInvalid(pDecl, (iBegin + iEnd) / 2, iEnd);
+    }
+
+    /** Pair test for redefined long name or short name. */
+    struct CRedefine
+    {
+        static constexpr bool Test(const COptionDecl& stLeft, const COptionDecl& stRight, uint32_t, uint32_t)
+        {
+            return Equal(stLeft.m_pLongName, stRight.m_pLongName)
+                || (stLeft.m_cShortName != '\0' && stLeft.m_cShortName == stRight.m_cShortName);
+        }
+    };
+
+    /** Pair test for slot collision of name hash with the seed. */
+    struct CCollide
+    {
+        static constexpr bool Test(uint32_t uLeft, uint32_t uRight, uint32_t uSeed, uint32_t uMask)
+        {
+            return CPerfectIndex::Slot(uLeft, uSeed, uMask) == CPerfectIndex::Slot(uRight, uSeed, uMask);
+        }
+    };
+
+    /** Check if any pair in range [iBegin, iEnd) hit the test.
+     * @note Divide the range to keep the recursion depth in log(n).
+     * */
+    template <typename testT, typename itemT>
+    static constexpr bool AnyPair(const itemT* pDecl, uint32_t uSeed, uint32_t uMask, size_t iBegin, size_t iEnd)
+    {
+        return iEnd - iBegin <= 1 ? false
+            : AnyPair<testT, itemT>(pDecl, uSeed, uMask, iBegin, (iBegin + iEnd) / 2)
+            || AnyPair<testT, itemT>(pDecl, uSeed, uMask, (iBegin + iEnd) / 2, iEnd)
+            || AnyCross<testT, itemT>(pDecl, uSeed, uMask, iBegin, (iBegin + iEnd) / 2, (iBegin + iEnd) / 2, iEnd);
+    }
+
+    /** Check if any pair between range [iLeft, iLeftEnd) and [iRight, iRightEnd) hit the test. */
+    template <typename testT, typename itemT>
+    static constexpr bool AnyCross(const itemT* pDecl, uint32_t uSeed, uint32_t uMask,
+            size_t iLeft, size_t iLeftEnd, size_t iRight, size_t iRightEnd)
+    {
+        return iLeftEnd - iLeft > 1
+            ? AnyCross<testT, itemT>(pDecl, uSeed, uMask, iLeft, (iLeft + iLeftEnd) / 2, iRight, iRightEnd)
+            || AnyCross<testT, itemT>(pDecl, uSeed, uMask, (iLeft + iLeftEnd) / 2, iLeftEnd, iRight, iRightEnd)
+            : iRightEnd - iRight > 1
+            ? AnyCross<testT, itemT>(pDecl, uSeed, uMask, iLeft, iLeftEnd, iRight, (iRight + iRightEnd) / 2)
+            || AnyCross<testT, itemT>(pDecl, uSeed, uMask, iLeft, iLeftEnd, (iRight + iRightEnd) / 2, iRightEnd)
+            : testT::Test(pDecl[iLeft], pDecl[iRight], uSeed, uMask);
+    }
+
+    /** Find the first seed in [uBegin, uEnd) without collision, or SEED_NONE. */
+    static constexpr uint32_t FindSeed(const uint32_t* pDecl, size_t nDecl, uint32_t uMask, uint32_t uBegin, uint32_t uEnd)
+    {
+        return uEnd - uBegin == 1
+            ? (AnyPair<CCollide>(pDecl, uBegin, uMask, 0, nDecl) ? SEED_NONE : uBegin)
+            : FindSeedRight(FindSeed(pDecl, nDecl, uMask, uBegin, (uBegin + uEnd) / 2),
+                    pDecl, nDecl, uMask, (uBegin + uEnd) / 2, uEnd);
+    }
+
+    /** Only search the right half when not found in the left. */
+    static constexpr uint32_t FindSeedRight(uint32_t uLeft, const uint32_t* pDecl, size_t nDecl, uint32_t uMask, uint32_t uBegin, uint32_t uEnd)
+    {
+        return uLeft != SEED_NONE ? uLeft : FindSeed(pDecl, nDecl, uMask, uBegin, uEnd);
+    }
+
+    /** Initial slot count, power of 2 and at least n*n/8, so that about
+     * one seed in 50 has no collision.
+     * */
+    static constexpr uint32_t InitSlot(size_t nDecl, uint32_t nSlot = 16)
+    {
+        return nSlot * 8 >= nDecl * nDecl ? nSlot : InitSlot(nDecl, nSlot * 2);
+    }
+
+    /** Find the slot mask for a seed, double the slots if not found. */
+    static constexpr uint32_t FindMask(const uint32_t* pDecl, size_t nDecl, uint32_t nSlot)
+    {
+        return nSlot > (1u << 20) ? 0
+            : FindSeed(pDecl, nDecl, nSlot - 1, 0, SEED_LIMIT) != SEED_NONE ? nSlot - 1
+            : FindMask(pDecl, nDecl, nSlot * 2);
+    }
+
+    /** The declared index of option in slot, or -1. */
+    static constexpr int SlotOwner(const uint32_t* pDecl, uint32_t uSeed, uint32_t uMask, uint32_t uSlot, size_t iBegin, size_t iEnd)
+    {
+        return iEnd - iBegin == 1
+            ? (CPerfectIndex::Slot(pDecl[iBegin], uSeed, uMask) == uSlot ? static_cast<int>(iBegin) : -1)
+            : SlotOwnerRight(SlotOwner(pDecl, uSeed, uMask, uSlot, iBegin, (iBegin + iEnd) / 2),
+                    pDecl, uSeed, uMask, uSlot, (iBegin + iEnd) / 2, iEnd);
+    }
+
+    static constexpr int SlotOwnerRight(int iLeft, const uint32_t* pDecl, uint32_t uSeed, uint32_t uMask, uint32_t uSlot, size_t iBegin, size_t iEnd)
+    {
+        return iLeft >= 0 ? iLeft : SlotOwner(pDecl, uSeed, uMask, uSlot, iBegin, iEnd);
+    }
+};
+
+/** Integer sequence for array initialization, as std::index_sequence. */
+template <size_t... I> struct CIndexSeq {};
+
+template <typename leftT, typename rightT> struct CIndexConcat;
+template <size_t... I, size_t... J>
+struct CIndexConcat<CIndexSeq<I...>, CIndexSeq<J...>>
+{
+    typedef CIndexSeq<I..., (sizeof...(I) + J)...> type;
+};
+
+/** Make sequence 0..N-1, by halves to keep template depth in log(N). */
+template <size_t N>
+struct CIndexMake
+{
+    typedef typename CIndexConcat<typename CIndexMake<N / 2>::type,
+            typename CIndexMake<N - N / 2>::type>::type type;
+};
+template <> struct CIndexMake<0> { typedef CIndexSeq<> type; };
+template <> struct CIndexMake<1> { typedef CIndexSeq<0> type; };
+
+/** Option table declared in `declT::value`, checked and hashed at compile time.
+ * @note Suit for tens of options, larger table may cost much compile time.
+ * */
+template <typename declT>
+struct CStaticSpec
+{
+    static constexpr size_t COUNT = sizeof(declT::value) / sizeof(declT::value[0]);
+    static_assert(!CStaticDecl::AnyInvalid(declT::value, 0, COUNT), "option name invalid");
+    static_assert(!CStaticDecl::AnyPair<CStaticDecl::CRedefine>(declT::value, 0, 0, 0, COUNT), "option name redefined");
+
+    /** Hash of each long name, computed only once. */
+    template <typename seqT> struct CHash;
+    template <size_t... I>
+    struct CHash<CIndexSeq<I...>>
+    {
+        static constexpr uint32_t value[] = { CPerfectIndex::Hash(declT::value[I].m_pLongName)... };
+    };
+    typedef CHash<typename CIndexMake<COUNT>::type> CHashTable;
+
+    static constexpr uint32_t MASK = CStaticDecl::FindMask(CHashTable::value, COUNT, CStaticDecl::InitSlot(COUNT));
+    static_assert(MASK != 0, "no perfect hash for option names");
+    static constexpr uint32_t SEED = CStaticDecl::FindSeed(CHashTable::value, COUNT, MASK, 0, CStaticDecl::SEED_LIMIT);
+
+    /** Declared index of option in each slot. */
+    template <typename seqT> struct CSlot;
+    template <size_t... I>
+    struct CSlot<CIndexSeq<I...>>
+    {
+        static constexpr int value[] = { CStaticDecl::SlotOwner(CHashTable::value, SEED, MASK, I, 0, COUNT)... };
+    };
+    typedef CSlot<typename CIndexMake<MASK + 1>::type> CSlotTable;
+
+    static const CPerfectIndex& Index()
+    {
+        static const CPerfectIndex s_stIndex = { declT::value, COUNT, SEED, MASK, CSlotTable::value };
+        return s_stIndex;
+    }
+};
+
+template <typename declT>
+template <size_t... I>
+constexpr uint32_t CStaticSpec<declT>::CHash<CIndexSeq<I...>>::value[];
+
+template <typename declT>
+template <size_t... I>
+constexpr int CStaticSpec<declT>::CSlot<CIndexSeq<I...>>::value[];
+
+/** Get the perfect hash index for option table `declT::value`, to pass to
+ * @ref CEnvBase::Declare().
+ * */
+template <typename declT>
+const CPerfectIndex& StaticSpec()
+{
+    return CStaticSpec<declT>::Index();
+}
+
+} /* cli */
+
+#endif /* end of include guard: CLIOP_STATIC_H__ */
@@ -3,18 +3,33 @@
 #include <cassert>
 #include <errno.h>
 #include <fstream>
+#include <mutex>
+#include <algorithm>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <signal.h>
+#include <dlfcn.h>
+#include <chrono>
 #include "util-string.h"
 
+extern char** environ;
+
 namespace cli
 {
 
 const char* OPTION_NAME_HELP = "help";
 const char* OPTION_NAME_CONFIG = "config";
 const char* OPTION_NAME_VERSION = "version";
+const char* OPTION_NAME_STATS = "cliop-stats";
 
+// the handler may be set while other threads are reporting error
 static FErrorHandler s_fnErrorReporter;
+static std::mutex s_mtxErrorReporter;
 FErrorHandler SetErrorHandler(FErrorHandler fn)
 {
+    std::lock_guard<std::mutex> lock(s_mtxErrorReporter);
     FErrorHandler old = s_fnErrorReporter;
     s_fnErrorReporter = fn;
     return old;
@@ -22,17 +37,22 @@ FErrorHandler SetErrorHandler(FErrorHandler fn)
 
 static void ReportError(int code, const std::string& text)
 {
-    if (s_fnErrorReporter)
+    FErrorHandler fnReporter;
+    {
+        std::lock_guard<std::mutex> lock(s_mtxErrorReporter);
+        fnReporter = s_fnErrorReporter;
+    }
+    if (fnReporter)
     {
-        return s_fnErrorReporter(code, text);
+        return fnReporter(code, text);
     }
     fprintf(stderr, "E%d: %s\n", code, text.c_str());
 }
 
 // invalid argument, option name or subcommand name
-inline bool IsInvalidArgument(const std::string& strArg)
+inline bool IsInvalidArgument(const util::CStrView& strArg)
 {
-    return (strArg.empty() || strArg[0] == '-' || strArg.find('=') != std::string::npos);
+    return (strArg.empty() || strArg[0] == '-' || strArg.find('=') != util::CStrView::npos);
 }
 
 struct CErrorTips
@@ -48,9 +68,12 @@ struct CErrorTips
         m_mapTips[ERROR_CODE_CONFIG_INVALID] = "config line may confuse or invalid";
         m_mapTips[ERROR_CODE_ARGUMENT_INVALID] = "argument may confuse or invalid";
         m_mapTips[ERROR_CODE_ARGTYPE_UNMATCH] = "argument bound type is unmatch";
+        m_mapTips[ERROR_CODE_ARGUMENT_OVERFLOW] = "argument number out of range";
         m_mapTips[ERROR_CODE_POSITION_BIND] = "position argument bound index mistake";
         m_mapTips[ERROR_CODE_OPTION_REQUIRED] = "required option absent";
         m_mapTips[ERROR_CODE_OPTION_UNKNOWN] = "unexpected option encountered";
+        m_mapTips[ERROR_CODE_RESPONSE_DEPTH] = "response file nested too deep";
+        m_mapTips[ERROR_CODE_PLUGIN_LOAD] = "can't create sub-command or load its plugin";
 
         m_mapTips[ERROR_CODE_OPTION_INVALID] = "option name may confuse or invalid";
         m_mapTips[ERROR_CODE_OPTION_REDEFINE] = "option name is redefined";
@@ -93,40 +116,165 @@ void CErrorRun::SetError(int code, const std::string& context)
     }
 }
 
-void ConvertValue(const std::string& src, std::string &dest)
+int ConvertValue(const std::string& src, std::string &dest)
 {
     dest = src;
+    return 0;
 }
 
-void ConvertValue(const std::string& src, int &dest)
+int ConvertValue(const std::string& src, int &dest)
+{
+    return util::ParseNumber(src, dest);
+}
+int ConvertValue(const std::string& src, int64_t &dest)
+{
+    return util::ParseNumber(src, dest);
+}
+int ConvertValue(const std::string& src, uint64_t &dest)
 {
-    dest = atoi(src.c_str());
+    return util::ParseNumber(src, dest);
 }
-void ConvertValue(const std::string& src, double &dest)
+int ConvertValue(const std::string& src, double &dest)
 {
-    dest = atof(src.c_str());
+    return util::ParseNumber(src, dest);
 }
-void ConvertValue(const std::string& src, std::vector<std::string> &dest)
+int ConvertValue(const std::string& src, float &dest)
+{
+    return util::ParseNumber(src, dest);
+}
+int ConvertValue(const std::string& src, std::vector<std::string> &dest)
 {
     util::SplitByNull(src, dest);
+    return 0;
+}
+
+// convert each item in string joined by '\0', return the first error
+template <typename valueT>
+static int ConvertList(const std::string& src, std::vector<valueT> &dest)
+{
+    int iRet = 0;
+    size_t iBegin = 0;
+    while (iBegin < src.size())
+    {
+        size_t iEnd = src.find('\0', iBegin);
+        if (iEnd == std::string::npos)
+        {
+            iEnd = src.size();
+        }
+        valueT value = 0;
+        int iItem = util::ParseNumber(util::CStrView(src.data() + iBegin, iEnd - iBegin), value);
+        if (iRet == 0)
+        {
+            iRet = iItem;
+        }
+        dest.push_back(value);
+        iBegin = iEnd + 1;
+    }
+    return iRet;
+}
+
+int ConvertValue(const std::string& src, std::vector<int> &dest)
+{
+    return ConvertList(src, dest);
+}
+int ConvertValue(const std::string& src, std::vector<double> &dest)
+{
+    return ConvertList(src, dest);
+}
+
+void CNameIndex::Clear()
+{
+    for (auto it = m_vecSlot.begin(); it != m_vecSlot.end(); ++it)
+    {
+        it->m_iId = -1;
+    }
+    m_nCount = 0;
+}
+
+void CNameIndex::Place(uint32_t uHash, int iId)
+{
+    size_t uMask = m_vecSlot.size() - 1;
+    size_t i = uHash & uMask;
+    while (m_vecSlot[i].m_iId >= 0)
+    {
+        i = (i + 1) & uMask;
+    }
+    m_vecSlot[i].m_uHash = uHash;
+    m_vecSlot[i].m_iId = iId;
+}
+
+void CNameIndex::Rehash(size_t nSlot)
+{
+    std::vector<CSlot> vecOld(nSlot);
+    vecOld.swap(m_vecSlot);
+    for (auto it = vecOld.begin(); it != vecOld.end(); ++it)
+    {
+        if (it->m_iId >= 0)
+        {
+            Place(it->m_uHash, it->m_iId);
+        }
+    }
+}
+
+void CArgument::Clear(size_t nOption)
+{
+    m_vecOption.assign(nOption, CArgSlot());
+    m_vecUnknown.clear();
+    m_stUnknownIndex.Clear();
+    m_vecValue.clear();
+    m_vecArgs.clear();
+    m_strBuffer.clear();
+}
+
+CArgValue CArgument::Keep(const util::CStrView& strValue)
+{
+    CArgValue stValue;
+    stValue.m_iOffset = m_strBuffer.size();
+    stValue.m_nSize = strValue.size();
+    m_strBuffer.append(strValue.data(), strValue.size());
+    return stValue;
 }
-void ConvertValue(const std::string& src, std::vector<int> &dest)
+
+int CArgument::FindUnknown(const util::CStrView& strName) const
+{
+    return m_stUnknownIndex.Find(strName.data(), strName.size(),
+            [this](int id) { return View(m_vecUnknown[id].m_stName); });
+}
+
+int CArgument::Append(CArgSlot& stSlot, const CArgValue& stValue)
+{
+    int iValue = m_vecValue.size();
+    m_vecValue.push_back(stValue);
+    if (stSlot.m_iLast >= 0)
+    {
+        m_vecValue[stSlot.m_iLast].m_iNext = iValue;
+    }
+    else
+    {
+        stSlot.m_iFirst = iValue;
+    }
+    stSlot.m_iLast = iValue;
+    stSlot.m_nCount++;
+    return iValue;
+}
+
+const CArgValue* CArgument::GetOption(int iOption) const
 {
-    std::vector<std::string> vecSplit;
-    util::SplitByNull(src, vecSplit);
-    for (auto it = vecSplit.begin(); it != vecSplit.end(); ++it)
+    if (iOption < 0 || iOption >= (int)m_vecOption.size() || m_vecOption[iOption].m_iFirst < 0)
     {
-        dest.push_back(atoi(it->c_str()));
+        return nullptr;
     }
+    return &m_vecValue[m_vecOption[iOption].m_iFirst];
 }
-void ConvertValue(const std::string& src, std::vector<double> &dest)
+
+const CArgValue* CArgument::GetUnknown(const util::CStrView& strName) const
 {
-    std::vector<std::string> vecSplit;
-    util::SplitByNull(src, vecSplit);
-    for (auto it = vecSplit.begin(); it != vecSplit.end(); ++it)
+    int iUnknown = FindUnknown(strName);
+    if (iUnknown < 0)
     {
-        dest.push_back(atof(it->c_str()));
+        return nullptr;
     }
+    return &m_vecValue[m_vecUnknown[iUnknown].m_iValue];
 }
 
 COption::COption(const std::string& strLongName)
@@ -138,42 +286,171 @@ COption::COption(char cShortName, const std::string& strLongName, const std::str
 
 #define CHECK_ERROR do { if (!m_stError) return m_stError.Code(); } while(0)
 
-int CEnvBase::Feed(const std::vector<std::string>& vecArgs)
+FArgSource StreamSource(int fd)
+{
+    std::shared_ptr<util::CTokenReader> pReader = std::make_shared<util::CTokenReader>();
+    pReader->Attach(fd);
+    return [pReader](util::CStrView& strArg) { return pReader->Next(strArg); };
+}
+
+uint64_t CParseStats::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CParseStats::Format(std::string& outText) const
+{
+    static const char* s_aPhaseName[PARSE_PHASE_COUNT] = {
+        "env", "cmdline", "move", "config", "bind", "check",
+    };
+
+    util::CTextAlign stTable;
+    std::vector<std::string> vecRow;
+    char szBuffer[32];
+    uint64_t nTotal = 0;
+    for (int i = 0; i < PARSE_PHASE_COUNT; ++i)
+    {
+        nTotal += m_aPhaseNs[i];
+        snprintf(szBuffer, sizeof(szBuffer), "%.3f us", m_aPhaseNs[i] / 1000.0);
+        vecRow = {std::string("time.") + s_aPhaseName[i] + ":", szBuffer};
+        stTable.AddLine(vecRow);
+    }
+    snprintf(szBuffer, sizeof(szBuffer), "%.3f us", nTotal / 1000.0);
+    vecRow = {"time.total:", szBuffer};
+    stTable.AddLine(vecRow);
+
+    const std::pair<const char*, uint64_t> aCount[] = {
+        {"feed:", m_nFeed}, {"token:", m_nToken}, {"config.line:", m_nConfigLine},
+        {"copy.bytes:", m_nCopyBytes}, {"lookup:", m_nLookup},
+    };
+    for (auto& item : aCount)
+    {
+        vecRow = {item.first, std::to_string(item.second)};
+        stTable.AddLine(vecRow);
+    }
+    outText.append(stTable.GetText());
+}
+
+CParseContext::CParseContext(std::shared_ptr<const CEnvSpec> pSpec)
+    : m_pSpec(pSpec)
+{
+    // option ids such as --config are only resolved by CEnvBase::Freeze()
+    assert(m_pSpec && m_pSpec->m_bFrozen);
+    for (auto it = m_pSpec->m_setCatch.begin(); it != m_pSpec->m_setCatch.end(); ++it)
+    {
+        m_stError.CatchError(*it);
+    }
+}
+
+int CParseContext::Feed(const std::vector<std::string>& vecArgs)
+{
+    ClearArgument();
+
+    m_vecTokens.clear();
+    for (auto it = vecArgs.begin(); it != vecArgs.end(); ++it)
+    {
+        m_vecTokens.push_back(*it);
+    }
+
+    m_bKeepToken = true;
+    int nRet = FeedTokens();
+    m_bKeepToken = false;
+    return nRet;
+}
+
+int CParseContext::Feed(const FArgSource& fnSource)
+{
+    ClearArgument();
+    m_vecTokens.clear();
+
+    m_bKeepToken = true;
+    int nRet = FeedTokens(fnSource);
+    m_bKeepToken = false;
+    return nRet;
+}
+
+int CParseContext::Feed(int argc, const char* argv[])
 {
     ClearArgument();
+    m_vecTokens.clear();
+    for (int i = 1; i < argc && argv[i] != nullptr; ++i)
+    {
+        m_vecTokens.push_back(util::CStrView(argv[i]));
+    }
+    return FeedTokens();
+}
 
-    ParseCmdline(vecArgs); CHECK_ERROR;
+// add time of the phase to stats, only branch when disabled
+#define MARK_PHASE(phase) do { if (m_pStats) uPhase = m_pStats->Mark(phase, uPhase); } while(0)
 
-    if(Has(OPTION_NAME_HELP) && m_pSubCommand == nullptr)
+int CParseContext::FeedTokens(const FArgSource& fnSource)
+{
+    uint64_t uPhase = 0;
+    if (m_pStats)
+    {
+        m_pStats->m_nFeed++;
+        uPhase = CParseStats::Now();
+    }
+
+    LoadEnvironment();
+    MARK_PHASE(PARSE_PHASE_ENV);
+    m_nArgMoved = 0;
+    m_bArgMoving = true;
+    if (fnSource)
+    {
+        ParseStream(fnSource);
+    }
+    else
+    {
+        ParseCmdline(m_vecTokens);
+    }
+    m_bArgMoving = false;
+    MARK_PHASE(PARSE_PHASE_CMDLINE);
+    CHECK_ERROR;
+
+    if (m_stArgRecv.GetOption(m_pSpec->m_iHelpOption) && OnHelp(false))
     {
-        Help();
         return ERROR_CODE_HELP;
     }
-    if(Has(OPTION_NAME_VERSION) && m_pSubCommand == nullptr)
+    if (m_stArgRecv.GetOption(m_pSpec->m_iVersionOption) && OnHelp(true))
     {
-        HelpVersion();
         return ERROR_CODE_HELP;
     }
 
     MoveArgument(); CHECK_ERROR;
 
+    m_vecCmdline.assign(m_pSpec->m_vecOptions.size(), false);
+    for (size_t i = 0; i < m_vecCmdline.size() && i < m_stArgRecv.m_vecOption.size(); ++i)
+    {
+        m_vecCmdline[i] = m_stArgRecv.m_vecOption[i].m_nCount > 0;
+    }
+    MARK_PHASE(PARSE_PHASE_MOVE);
+
     // read config file
-    std::vector<std::string> cfgArgs;
-    std::string strFile = Get(OPTION_NAME_CONFIG);
-    if (strFile != "NONE")
+    if (m_pSpec->m_iConfigOption >= 0)
     {
-        ReadConfig(strFile, cfgArgs); CHECK_ERROR;
-        ParseCmdline(cfgArgs); CHECK_ERROR;
+        std::string strFile = Lookup(m_pSpec->m_vecOptions[m_pSpec->m_iConfigOption].m_strLongName).ToString();
+        if (strFile != "NONE")
+        {
+            ReadConfig(strFile);
+        }
     }
+    MARK_PHASE(PARSE_PHASE_CONFIG);
+    CHECK_ERROR;
 
-    GetBind(); CHECK_ERROR;
+    OnReceived();
+    MARK_PHASE(PARSE_PHASE_BIND);
+    CHECK_ERROR;
 
-    if (!CheckRequiredOption())
+    bool bRequired = CheckRequiredOption();
+    bool bUnknown = !bRequired || !m_stError.IsCatch(ERROR_CODE_OPTION_UNKNOWN) || CheckUnknownOption();
+    MARK_PHASE(PARSE_PHASE_CHECK);
+    if (!bRequired)
     {
         return ERROR_CODE_OPTION_REQUIRED;
     }
-
-    if (m_stError.IsCatch(ERROR_CODE_OPTION_UNKNOWN) && !CheckUnknownOption())
+    if (!bUnknown)
     {
         return ERROR_CODE_OPTION_UNKNOWN;
     }
@@ -181,6 +458,98 @@ int CEnvBase::Feed(const std::vector<std::string>& vecArgs)
     return 0;
 }
 
+#undef MARK_PHASE
+
+CEnvBase::CEnvBase()
+    : m_pSetup(std::make_shared<CEnvSpec>())
+{
+    m_pSpec = m_pSetup;
+}
+
+CEnvBase::~CEnvBase()
+{
+    if (m_fdWatch >= 0)
+    {
+        close(m_fdWatch);
+    }
+}
+
+int CParseContext::FeedConfig(const std::string& strFile)
+{
+    ClearArgument();
+    if (m_stArgRecv.m_vecOption.size() < m_pSpec->m_vecOptions.size())
+    {
+        m_stArgRecv.m_vecOption.resize(m_pSpec->m_vecOptions.size());
+    }
+    ReadConfig(strFile); CHECK_ERROR;
+    return 0;
+}
+
+int CEnvBase::Feed(const std::vector<std::string>& vecArgs)
+{
+    if (!m_pSpec->m_bFrozen)
+    {
+        Freeze(); CHECK_ERROR;
+    }
+    int nRet = CParseContext::Feed(vecArgs);
+    PrintStats();
+    if (nRet == 0 && m_bPublish)
+    {
+        m_stPublisher.Publish(MakeSnapshot());
+    }
+    return nRet;
+}
+
+size_t CEnvBase::FeedBatch(const FArgSource& fnLine, CBatchResult& stResult)
+{
+    if (!m_pSpec->m_bFrozen)
+    {
+        Freeze();
+    }
+    return CParseContext::FeedBatch(fnLine, stResult);
+}
+
+size_t CEnvBase::FeedBatch(const std::vector<std::string>& vecLines, CBatchResult& stResult)
+{
+    if (!m_pSpec->m_bFrozen)
+    {
+        Freeze();
+    }
+    return CParseContext::FeedBatch(vecLines, stResult);
+}
+
+int CEnvBase::Feed(const FArgSource& fnSource)
+{
+    if (!m_pSpec->m_bFrozen)
+    {
+        Freeze(); CHECK_ERROR;
+    }
+    int nRet = CParseContext::Feed(fnSource);
+    PrintStats();
+    if (nRet == 0 && m_bPublish)
+    {
+        m_stPublisher.Publish(MakeSnapshot());
+    }
+    return nRet;
+}
+
+bool CEnvBase::OnHelp(bool bVersion)
+{
+    if (m_pSubCommand != nullptr)
+    {
+        return false;
+    }
+    if (bVersion)
+    {
+        HelpVersion();
+    }
+    else
+    {
+        Help();
+    }
+    return true;
+}
+
 int CEnvBase::Feed(int argc, char* argv[])
 {
     return Feed(argc, const_cast<const char**>(argv));
@@ -203,18 +572,34 @@ int CEnvBase::Feed(int argc, const char* argv[])
     int iShift = 0;
     m_pSubCommand = FindCommand(argc, argv, iShift);
 
+    // never run as this command if the sub-command cannot be created
+    if (m_pSubCommand && !m_pSubCommand->m_pEnvBase
+            && (m_pSubCommand->m_fnFactory || !m_pSubCommand->m_strPlugin.empty())
+            && !CreateCommand(*m_pSubCommand))
+    {
+        return ERROR_CODE_PLUGIN_LOAD;
+    }
+
     if (m_pSubCommand && m_pSubCommand->m_pEnvBase)
     {
         return m_pSubCommand->m_pEnvBase->Feed(argc-iShift, argv+iShift);
     }
 
-    std::vector<std::string> vecArgs;
+    if (!m_pSpec->m_bFrozen)
+    {
+        Freeze(); CHECK_ERROR;
+    }
+
+    // argv live long enough, only save the view to it
+    ClearArgument();
+    m_vecTokens.clear();
     for (int i = iShift + 1; i < argc && argv[i] != nullptr; ++i)
     {
-        vecArgs.push_back(argv[i]);
+        m_vecTokens.push_back(util::CStrView(argv[i]));
     }
 
-    int nRet = Feed(vecArgs);
+    int nRet = FeedTokens();
+    PrintStats();
     if (nRet != 0)
     {
         return nRet;
@@ -226,6 +611,11 @@ int CEnvBase::Feed(int argc, const char* argv[])
         return ERROR_CODE_COMMAND_UNKNOWN;
     }
 
+    if (m_bPublish)
+    {
+        m_stPublisher.Publish(MakeSnapshot());
+    }
+
     if (m_pSubCommand && m_pSubCommand->m_fnHandler)
     {
         nRet = m_pSubCommand->m_fnHandler(argc-iShift, argv+iShift, this);
@@ -242,219 +632,508 @@ int CEnvBase::Feed(int argc, const char* argv[])
     return nRet;
 }
 
-int CEnvBase::ParseCmdline(const std::vector<std::string>& vecArgs, size_t pos)
+int CParseContext::ParseCmdline(const std::vector<util::CStrView>& vecArgs, size_t pos)
 {
-    ReservedOption();
-    bool bEndOption = false;
-    COption* pLastOption = nullptr;
-    std::string strLastOption;
+    if (m_stArgRecv.m_vecOption.size() < m_pSpec->m_vecOptions.size())
+    {
+        m_stArgRecv.m_vecOption.resize(m_pSpec->m_vecOptions.size());
+    }
+    CParseState stState;
     for (size_t i = pos; i < vecArgs.size(); ++i)
     {
-        if (vecArgs[i].empty())
-        {
-            continue;
-        }
-        if (vecArgs[i] == "--")
-        {
-            bEndOption = true;
-            continue;
-        }
-        if (bEndOption)
+        int iRet = ParseToken(vecArgs[i], stState);
+        if (iRet != 0)
         {
-            SaveArgument(vecArgs[i]);
-            continue;
+            return iRet;
         }
+    }
+    return FinishParse(stState);
+}
 
-        if (pLastOption != nullptr)
-        {
-            CheckOptionArgument(vecArgs[i]);
-            SaveOption(*pLastOption, vecArgs[i]);
-            pLastOption = nullptr;
-            continue;
-        }
-        else if(!strLastOption.empty())
+int CParseContext::ParseStream(const FArgSource& fnSource)
+{
+    if (m_stArgRecv.m_vecOption.size() < m_pSpec->m_vecOptions.size())
+    {
+        m_stArgRecv.m_vecOption.resize(m_pSpec->m_vecOptions.size());
+    }
+    CParseState stState;
+    util::CStrView strArg;
+    while (fnSource(strArg))
+    {
+        int iRet = ParseToken(strArg, stState);
+        if (iRet != 0)
         {
-            CheckOptionArgument(vecArgs[i]);
-            SaveOption(strLastOption, vecArgs[i]);
-            strLastOption.clear();
-            continue;
+            return iRet;
         }
-        CHECK_ERROR;
+    }
+    return FinishParse(stState);
+}
 
-        std::string strArgTemp = vecArgs[i];
-        size_t iDash= util::TrimLeft(strArgTemp, '-');
-        size_t iEqual = strArgTemp.find('=');
-        if (iEqual == 0)
-        {
-            SaveArgument(vecArgs[i]);
-            continue;
-        }
+int CParseContext::ParseToken(const util::CStrView& strArg, CParseState& stState)
+{
+    if (m_pStats)
+    {
+        m_pStats->m_nToken++;
+    }
+    if (strArg.empty())
+    {
+        return 0;
+    }
+    if (strArg == "--")
+    {
+        stState.m_bEndOption = true;
+        return 0;
+    }
+    if (stState.m_bEndOption)
+    {
+        SaveArgument(strArg);
+        return 0;
+    }
+
+    if (stState.m_pLastOption != nullptr)
+    {
+        CheckOptionArgument(strArg);
+        SaveOption(*stState.m_pLastOption, strArg);
+        stState.m_pLastOption = nullptr;
+        return 0;
+    }
+    else if (!stState.m_strLastOption.empty())
+    {
+        CheckOptionArgument(strArg);
+        SaveOption(stState.m_strLastOption, strArg);
+        stState.m_strLastOption = util::CStrView();
+        return 0;
+    }
+    CHECK_ERROR;
+
+    if (strArg[0] == '@' && strArg.size() > 1 && m_pSpec->m_nResponseDepth > 0)
+    {
+        return ParseResponse(strArg, stState);
+    }
+
+    size_t iDash = 0;
+    while (iDash < strArg.size() && strArg[iDash] == '-')
+    {
+        iDash++;
+    }
+    util::CStrView strArgTemp = strArg.substr(iDash);
+    size_t iEqual = strArgTemp.find('=');
+    if (iEqual == 0)
+    {
+        SaveArgument(strArg);
+        return 0;
+    }
+
+    if (iEqual != util::CStrView::npos)
+    {
+        // --LongName=argument; even no leading - or empty after =
+        SaveNamed(strArgTemp.substr(0, iEqual), strArgTemp.substr(iEqual + 1));
+        return 0;
+    }
 
-        if (iEqual != std::string::npos)
+    if (iDash == 0 || iDash == strArg.size())
+    {
+        SaveArgument(strArg);
+    }
+    else if (iDash == 1)
+    {
+        // -flags : "lags" may argument or other falgs
+        for (size_t index = iDash; index < strArg.size(); ++index)
         {
-            // --LongName=argument; even no leading - or empty after =
-            std::string strOpt = strArgTemp.substr(0, iEqual);
-            std::string strArg = strArgTemp.substr(iEqual + 1);
-            COption* pOption = FindOption(strOpt);
-            if (pOption != nullptr)
+            char cOpt = strArg[index];
+            const COption* pOption = m_pSpec->FindOption(cOpt);
+            if (m_pStats)
             {
-                SaveOption(*pOption, strArg);
+                m_pStats->m_nLookup++;
             }
-            else
+            if (pOption != nullptr)
             {
-                SaveOption(strOpt, strArg);
-            }
-            continue;
-        }
-
-        if (iDash == 0 || iDash == vecArgs[i].size())
-        {
-            SaveArgument(vecArgs[i]);
-        }
-        else if (iDash == 1)
-        {
-            // -flags : "lags" may argument or other falgs
-            for (size_t index = iDash; index < vecArgs[i].size(); ++index)
-            {
-                char cOpt = vecArgs[i][index];
-                COption* pOption = FindOption(cOpt);
-                if (pOption != nullptr)
+                if (pOption->m_bArgument)
                 {
-                    if (pOption->m_bArgument)
+                    if (index + 1 == strArg.size())
                     {
-                        if (index + 1 == vecArgs[i].size())
-                        {
-                            pLastOption = pOption;
-                        }
-                        else
-                        {
-                            SaveOption(*pOption, vecArgs[i].substr(index + 1));
-                        }
-                        break;
+                        stState.m_pLastOption = pOption;
                     }
                     else
                     {
-                        SaveOption(*pOption);
+                        SaveOption(*pOption, strArg.substr(index + 1));
                     }
+                    break;
                 }
                 else
                 {
-                    SaveOption(cOpt);
+                    SaveOption(*pOption);
                 }
             }
+            else
+            {
+                SaveOption(cOpt);
+            }
         }
-        else
+    }
+    else
+    {
+        // --LongName
+        const COption* pOption = m_pSpec->FindOption(strArgTemp);
+        if (m_pStats)
         {
-            // --LongName
-            COption* pOption = FindOption(strArgTemp);
-            if (pOption != nullptr)
+            m_pStats->m_nLookup++;
+        }
+        if (pOption != nullptr)
+        {
+            if (pOption->m_bArgument)
             {
-                if (pOption->m_bArgument)
-                {
-                    pLastOption = pOption;
-                }
-                else
-                {
-                    SaveOption(*pOption);
-                }
+                stState.m_pLastOption = pOption;
             }
             else
             {
-                strLastOption = strArgTemp;
+                SaveOption(*pOption);
+            }
+        }
+        else
+        {
+            stState.m_strLastOption = strArgTemp;
+            if (m_bKeepToken)
+            {
+                // the token may not live to the next one from stream
+                stState.m_strLastKeep.assign(strArgTemp.data(), strArgTemp.size());
+                stState.m_strLastOption = stState.m_strLastKeep;
             }
         }
     }
+    return 0;
+}
 
-    if (pLastOption != nullptr || !strLastOption.empty())
+int CParseContext::FinishParse(const CParseState& stState)
+{
+    if (stState.m_pLastOption != nullptr || !stState.m_strLastOption.empty())
     {
         if (m_stError.IsCatch(ERROR_CODE_OPTION_INCOMPLETE))
         {
             m_stError.SetError(ERROR_CODE_OPTION_INCOMPLETE,
-                    pLastOption != nullptr ? pLastOption->m_strLongName : strLastOption);
+                    stState.m_pLastOption != nullptr ? stState.m_pLastOption->m_strLongName : stState.m_strLastOption.ToString());
             return ERROR_CODE_OPTION_INCOMPLETE;
         }
     }
     return 0;
 }
 
-bool CEnvBase::Has(const std::string& strOptionName)
+int CParseContext::ParseResponse(const util::CStrView& strArg, CParseState& stState)
+{
+    if (stState.m_nDepth >= m_pSpec->m_nResponseDepth)
+    {
+        if (m_stError.IsCatch(ERROR_CODE_RESPONSE_DEPTH))
+        {
+            m_stError.SetError(ERROR_CODE_RESPONSE_DEPTH, strArg.ToString());
+            return ERROR_CODE_RESPONSE_DEPTH;
+        }
+        SaveArgument(strArg);
+        return 0;
+    }
+
+    util::CTokenReader stReader;
+    if (!stReader.Open(strArg.substr(1).ToString()))
+    {
+        SaveArgument(strArg);
+        return 0;
+    }
+
+    // token from file is overwritten by next chunk
+    bool bKeepToken = m_bKeepToken;
+    m_bKeepToken = true;
+    stState.m_nDepth++;
+    int iRet = 0;
+    util::CStrView strToken;
+    while (iRet == 0 && stReader.Next(strToken))
+    {
+        iRet = ParseToken(strToken, stState);
+    }
+    stState.m_nDepth--;
+    m_bKeepToken = bKeepToken;
+    return iRet;
+}
+
+int CParseContext::OptionId(const util::CStrView& strOptionName)
+{
+    if (m_pStats)
+    {
+        m_pStats->m_nLookup++;
+    }
+    return m_pSpec->OptionId(strOptionName);
+}
+
+bool CParseContext::Has(const std::string& strOptionName)
 {
     if (strOptionName.empty())
     {
         return false;
     }
 
-    bool bArg = m_stArgRecv.m_mapArgs.count(strOptionName) > 0;
-    if (!bArg && strOptionName.size() == 1)
+    int iOption = OptionId(strOptionName);
+    if (iOption >= 0)
+    {
+        if (m_stArgRecv.GetOption(iOption) != nullptr)
+        {
+            return true;
+        }
+    }
+    else if (m_stArgRecv.GetUnknown(strOptionName) != nullptr)
+    {
+        return true;
+    }
+
+    if (strOptionName.size() == 1)
     {
-        COption* pOption = FindOption(strOptionName[0]);
+        const COption* pOption = m_pSpec->FindOption(strOptionName[0]);
         if (pOption != nullptr)
         {
-            bArg = Has(pOption->m_strLongName);
+            return m_stArgRecv.GetOption(pOption - &m_pSpec->m_vecOptions[0]) != nullptr;
         }
     }
-    return bArg;
+    return false;
+}
+
+/// join the value chain of a repeated option by '\0'.
+static std::string JoinValue(const CArgument& stArgRecv, const CArgValue* pValue)
+{
+    std::string strJoin;
+    for (const CArgValue* pFirst = pValue; pValue != nullptr; pValue = stArgRecv.Next(pValue))
+    {
+        if (pValue != pFirst)
+        {
+            strJoin.append(1, '\0');
+        }
+        util::CStrView strArg = stArgRecv.View(*pValue);
+        strJoin.append(strArg.data(), strArg.size());
+    }
+    return strJoin;
 }
 
-std::string CEnvBase::Get(const std::string& strOptionName)
+std::string CParseContext::Get(const std::string& strOptionName)
 {
     if (strOptionName == "--")
     {
         std::string strJoin;
-        util::Join(m_stArgRecv.m_vecArgs, strJoin, '\0');
+        for (auto it = m_stArgRecv.m_vecArgs.begin(); it != m_stArgRecv.m_vecArgs.end(); ++it)
+        {
+            if (it != m_stArgRecv.m_vecArgs.begin())
+            {
+                strJoin.append(1, '\0');
+            }
+            util::CStrView strArg = m_stArgRecv.View(*it);
+            strJoin.append(strArg.data(), strArg.size());
+        }
         return strJoin;
     }
 
+    // repeated option values joined by '\0'
+    const CArgValue* pValue = FindValue(strOptionName);
+    if (pValue != nullptr && pValue->m_iNext >= 0)
+    {
+        return JoinValue(m_stArgRecv, pValue);
+    }
+
+    return Lookup(strOptionName).ToString();
+}
+
+const CArgValue* CParseContext::FindValue(const util::CStrView& strOptionName)
+{
     if (strOptionName.empty())
     {
-        return "";
+        return nullptr;
     }
 
-    auto it = m_stArgRecv.m_mapArgs.find(strOptionName);
-    if (it != m_stArgRecv.m_mapArgs.end())
+    int iOption = OptionId(strOptionName);
+    if (iOption >= 0)
     {
-        return it->second;
+        return m_stArgRecv.GetOption(iOption);
     }
 
-    std::string strArg = GetDefault(strOptionName);
-    if (strArg.empty() && strOptionName.size() == 1)
+    const CArgValue* pValue = m_stArgRecv.GetUnknown(strOptionName);
+    if (pValue == nullptr && strOptionName.size() == 1)
     {
-        COption* pOption = FindOption(strOptionName[0]);
+        const COption* pOption = m_pSpec->FindOption(strOptionName[0]);
         if (pOption != nullptr)
         {
-            strArg = Get(pOption->m_strLongName);
+            pValue = m_stArgRecv.GetOption(pOption - &m_pSpec->m_vecOptions[0]);
+        }
+    }
+    return pValue;
+}
+
+template <typename fnValue>
+bool CParseContext::EachValue(const util::CStrView& strOptionName, fnValue fn)
+{
+    if (strOptionName == "--")
+    {
+        for (auto it = m_stArgRecv.m_vecArgs.begin(); it != m_stArgRecv.m_vecArgs.end(); ++it)
+        {
+            fn(m_stArgRecv.View(*it));
+        }
+        return !m_stArgRecv.m_vecArgs.empty();
+    }
+
+    const CArgValue* pValue = FindValue(strOptionName);
+    if (pValue == nullptr)
+    {
+        // default value may still joined by '\0'
+        util::CStrView strArg = Lookup(strOptionName);
+        if (strArg.empty())
+        {
+            return false;
+        }
+        size_t iBegin = 0;
+        size_t iEnd = 0;
+        while ((iEnd = strArg.find('\0', iBegin)) != util::CStrView::npos)
+        {
+            fn(strArg.substr(iBegin, iEnd - iBegin));
+            iBegin = iEnd + 1;
+        }
+        if (iBegin < strArg.size())
+        {
+            fn(strArg.substr(iBegin));
         }
+        return true;
     }
 
-    return strArg;
+    for (; pValue != nullptr; pValue = m_stArgRecv.Next(pValue))
+    {
+        fn(m_stArgRecv.View(*pValue));
+    }
+    return true;
 }
 
-std::string CEnvBase::GetDefault(const std::string& strOptionName)
+void CParseContext::LoadEnvironment()
 {
-    std::string strArg;
-    for (auto it = m_vecOptions.begin(); it != m_vecOptions.end(); ++it)
+    const CEnvSpec& stSpec = *m_pSpec;
+    m_vecEnvValue.resize(stSpec.m_vecOptions.size());
+    for (auto it = m_vecEnvValue.begin(); it != m_vecEnvValue.end(); ++it)
+    {
+        it->clear();
+    }
+    m_mapEnvImport.clear();
+    m_bEnvLoaded = true;
+    if (stSpec.m_stEnvIndex.Size() == 0 && stSpec.m_strEnvPrefix.empty())
+    {
+        return;
+    }
+
+    const std::string& strPrefix = stSpec.m_strEnvPrefix;
+    std::string strName;
+    for (char** ppEnv = environ; ppEnv != nullptr && *ppEnv != nullptr; ++ppEnv)
     {
-        if (strOptionName == it->m_strLongName)
+        const char* pEqual = strchr(*ppEnv, '=');
+        if (pEqual == nullptr || pEqual[1] == '\0')
         {
-            if (!it->m_strEnvName.empty())
-            {
-                const char* pszEnv = getenv(it->m_strEnvName.c_str());
-                if (pszEnv != nullptr)
-                {
-                    strArg = pszEnv;
-                }
-            }
-            if (strArg.empty())
-            {
-                strArg = it->m_strDefault;
-            }
-            break;
+            continue;
+        }
+        util::CStrView strEnvName(*ppEnv, pEqual - *ppEnv);
+        const char* pValue = pEqual + 1;
+
+        // explicit bound name overwrite the one by prefix
+        int iOption = stSpec.EnvOptionId(strEnvName);
+        if (iOption >= 0)
+        {
+            m_vecEnvValue[iOption] = pValue;
+            continue;
+        }
+
+        if (strPrefix.empty() || strEnvName.size() <= strPrefix.size()
+                || strncmp(strEnvName.data(), strPrefix.c_str(), strPrefix.size()) != 0)
+        {
+            continue;
+        }
+        strName.assign(strEnvName.data() + strPrefix.size(), strEnvName.size() - strPrefix.size());
+        for (auto it = strName.begin(); it != strName.end(); ++it)
+        {
+            *it = (*it == '_') ? '.' : tolower(static_cast<unsigned char>(*it));
+        }
+        iOption = stSpec.OptionId(strName);
+        if (iOption < 0)
+        {
+            std::replace(strName.begin(), strName.end(), '.', '_');
+            iOption = stSpec.OptionId(strName);
+            std::replace(strName.begin(), strName.end(), '_', '.');
+        }
+        if (iOption < 0)
+        {
+            m_mapEnvImport[strName] = pValue;
+        }
+        else if (m_vecEnvValue[iOption].empty())
+        {
+            m_vecEnvValue[iOption] = pValue;
+        }
+    }
+}
+
+util::CStrView CParseContext::EnvValue(int iOption)
+{
+    if (m_bEnvLoaded && static_cast<size_t>(iOption) < m_vecEnvValue.size())
+    {
+        return m_vecEnvValue[iOption];
+    }
+    const COption& stOption = m_pSpec->m_vecOptions[iOption];
+    if (!stOption.m_strEnvName.empty())
+    {
+        const char* pszEnv = getenv(stOption.m_strEnvName.c_str());
+        if (pszEnv != nullptr)
+        {
+            return util::CStrView(pszEnv);
+        }
+    }
+    return util::CStrView();
+}
+
+util::CStrView CParseContext::Lookup(const util::CStrView& strOptionName)
+{
+    const CArgValue* pValue = FindValue(strOptionName);
+    if (pValue != nullptr)
+    {
+        return m_stArgRecv.View(*pValue);
+    }
+
+    int iOption = m_pSpec->OptionId(strOptionName);
+    if (iOption < 0 && strOptionName.size() == 1)
+    {
+        iOption = m_pSpec->OptionId(strOptionName[0]);
+    }
+    if (iOption >= 0)
+    {
+        util::CStrView strEnv = EnvValue(iOption);
+        if (!strEnv.empty())
+        {
+            return strEnv;
         }
+        return m_pSpec->m_vecOptions[iOption].m_strDefault;
+    }
+
+    if (!m_mapEnvImport.empty())
+    {
+        auto it = m_mapEnvImport.find(strOptionName.ToString());
+        if (it != m_mapEnvImport.end())
+        {
+            return it->second;
+        }
+    }
+    return util::CStrView();
+}
+
+std::string CParseContext::GetDefault(const std::string& strOptionName)
+{
+    int iOption = m_pSpec->OptionId(strOptionName);
+    if (iOption < 0)
+    {
+        return std::string();
+    }
+    util::CStrView strEnv = EnvValue(iOption);
+    if (!strEnv.empty())
+    {
+        return strEnv.ToString();
     }
-    return strArg;
+    return m_pSpec->m_vecOptions[iOption].m_strDefault;
 }
 
-std::string CEnvBase::Get(size_t pos)
+std::string CParseContext::Get(size_t pos)
 {
     if (pos == 0)
     {
@@ -464,16 +1143,16 @@ std::string CEnvBase::Get(size_t pos)
     {
         return "";
     }
-    return m_stArgRecv.m_vecArgs[pos-1];
+    return m_stArgRecv.View(m_stArgRecv.m_vecArgs[pos-1]).ToString();
 }
 
-bool CEnvBase::Get(const std::string& strOptionName, bool& bArg)
+bool CParseContext::Get(const std::string& strOptionName, bool& bArg)
 {
     bArg = Has(strOptionName);
     return bArg;
 }
 
-bool CEnvBase::Get(const std::string& strOptionName, std::string& strArg)
+bool CParseContext::Get(const std::string& strOptionName, std::string& strArg)
 {
     std::string strGet = Get(strOptionName);
     if (!strGet.empty())
@@ -484,7 +1163,7 @@ bool CEnvBase::Get(const std::string& strOptionName, std::string& strArg)
     return false;
 }
 
-bool CEnvBase::Get(size_t pos, std::string& strArg)
+bool CParseContext::Get(size_t pos, std::string& strArg)
 {
     std::string strGet = Get(pos);
     if (!strGet.empty())
@@ -495,6 +1174,73 @@ bool CEnvBase::Get(size_t pos, std::string& strArg)
     return false;
 }
 
+bool CParseContext::Get(const std::string& strOptionName, std::vector<std::string>& vecArg, char cDelimiter)
+{
+    return EachValue(strOptionName, [&vecArg, cDelimiter](const util::CStrView& strArg)
+    {
+        if (cDelimiter == '\0')
+        {
+            vecArg.push_back(strArg.ToString());
+            return;
+        }
+        // the same rule as util::Split()
+        vecArg.reserve(vecArg.size() + util::CountChar(strArg, cDelimiter) + 1);
+        size_t iBegin = 0;
+        size_t iEnd = 0;
+        while ((iEnd = strArg.find(cDelimiter, iBegin)) != util::CStrView::npos)
+        {
+            vecArg.push_back(strArg.substr(iBegin, iEnd - iBegin).ToString());
+            iBegin = iEnd + 1;
+        }
+        if (iBegin < strArg.size())
+        {
+            vecArg.push_back(strArg.substr(iBegin).ToString());
+        }
+    });
+}
+
+// convert number list, invalid item is skipped
+template <typename valueT>
+static void AppendNumber(const util::CStrView& strArg, std::vector<valueT>& vecArg, char cDelimiter)
+{
+    // SplitNumber() append nothing if any item fail, then convert one by one
+    if (cDelimiter != '\0' && util::SplitNumber(strArg, vecArg, cDelimiter) == util::NUMBER_OK)
+    {
+        return;
+    }
+    size_t iBegin = 0;
+    while (iBegin <= strArg.size())
+    {
+        size_t iEnd = cDelimiter != '\0' ? strArg.find(cDelimiter, iBegin) : util::CStrView::npos;
+        if (iEnd == util::CStrView::npos)
+        {
+            iEnd = strArg.size();
+        }
+        valueT value = 0;
+        if (util::ParseNumber(strArg.substr(iBegin, iEnd - iBegin), value) == util::NUMBER_OK)
+        {
+            vecArg.push_back(value);
+        }
+        iBegin = iEnd + 1;
+    }
+}
+
+bool CParseContext::Get(const std::string& strOptionName, std::vector<int>& vecArg, char cDelimiter)
+{
+    return EachValue(strOptionName, [&vecArg, cDelimiter](const util::CStrView& strArg)
+    {
+        AppendNumber(strArg, vecArg, cDelimiter);
+    });
+}
+
+bool CParseContext::Get(const std::string& strOptionName, std::vector<double>& vecArg, char cDelimiter)
+{
+    return EachValue(strOptionName, [&vecArg, cDelimiter](const util::CStrView& strArg)
+    {
+        AppendNumber(strArg, vecArg, cDelimiter);
+    });
+}
+
 CEnvBase& CEnvBase::Version(const std::string& strVersion)
 {
     m_strVersion = strVersion;
@@ -542,6 +1288,67 @@ CEnvBase& CEnvBase::SubCommand(const std::string& strName, const std::string& st
     return AddCommand(stCommand);
 }
 
+CEnvBase& CEnvBase::SubCommand(const std::string& strName, const std::string& strDescription, FCommandFactory fnFactory)
+{
+    CommandInfo stCommand(strName, strDescription);
+    stCommand.m_fnFactory = fnFactory;
+    return AddCommand(stCommand);
+}
+
+CEnvBase& CEnvBase::PluginCommand(const std::string& strName, const std::string& strDescription,
+        const std::string& strPlugin, const std::string& strEntry)
+{
+    CommandInfo stCommand(strName, strDescription);
+    stCommand.m_strPlugin = strPlugin;
+    stCommand.m_strEntry = strEntry;
+    return AddCommand(stCommand);
+}
+
+bool CEnvBase::CreateCommand(CommandInfo& stCommand)
+{
+    if (stCommand.m_fnFactory)
+    {
+        stCommand.m_pOwned = stCommand.m_fnFactory();
+    }
+    else if (!stCommand.m_strPlugin.empty())
+    {
+        // keep loaded, the object and its vtable live in it
+        // clear stale error of other dl calls, dlerror() also reset it
+        dlerror();
+        void* pHandle = dlopen(stCommand.m_strPlugin.c_str(), RTLD_NOW | RTLD_LOCAL);
+        void* pSymbol = pHandle ? dlsym(pHandle, stCommand.m_strEntry.c_str()) : nullptr;
+        if (pSymbol == nullptr)
+        {
+            // copy before dlclose() which may overwrite the message
+            const char* pError = dlerror();
+            std::string strError = pError ? pError : stCommand.m_strPlugin;
+            if (pHandle != nullptr)
+            {
+                dlclose(pHandle);
+            }
+            if (m_stError.IsCatch(ERROR_CODE_PLUGIN_LOAD))
+            {
+                m_stError.SetError(ERROR_CODE_PLUGIN_LOAD, strError);
+            }
+            return false;
+        }
+        FPluginEntry fnEntry = reinterpret_cast<FPluginEntry>(pSymbol);
+        stCommand.m_pOwned.reset(fnEntry());
+    }
+
+    stCommand.m_pEnvBase = stCommand.m_pOwned.get();
+    if (stCommand.m_pEnvBase == nullptr)
+    {
+        if (m_stError.IsCatch(ERROR_CODE_PLUGIN_LOAD))
+        {
+            m_stError.SetError(ERROR_CODE_PLUGIN_LOAD, stCommand.m_strName);
+        }
+        return false;
+    }
+    stCommand.m_pEnvBase->Command(stCommand.m_strName, stCommand.m_strDescription);
+    return true;
+}
+
 CEnvBase& CEnvBase::AddCommand(const CommandInfo& stCommand)
 {
     if (m_stError.IsCatch(ERROR_CODE_SUBCMD_INVALID) && IsInvalidArgument(stCommand.m_strName))
@@ -556,6 +1363,9 @@ CEnvBase& CEnvBase::AddCommand(const CommandInfo& stCommand)
         return *this;
     }
 
+    // the first one take effect if redefined
+    m_stCommandIndex.Insert(stCommand.m_strName.data(), stCommand.m_strName.size(), m_vecCommand.size(),
+            [this](int id) -> const std::string& { return m_vecCommand[id].m_strName; });
     m_vecCommand.push_back(stCommand);
     return *this;
 }
@@ -580,7 +1390,7 @@ CEnvBase& CEnvBase::AddOption(const COption& stOption)
         return *this;
     }
 
-    if (m_stError.IsCatch(ERROR_CODE_OPTION_REDEFINE) && FindOption(stOption.m_strLongName) != nullptr)
+    if (m_stError.IsCatch(ERROR_CODE_OPTION_REDEFINE) && m_pSpec->FindOption(stOption.m_strLongName) != nullptr)
     {
         m_stError.SetError(ERROR_CODE_OPTION_REDEFINE, stOption.m_strLongName);
         return *this;
@@ -599,53 +1409,166 @@ CEnvBase& CEnvBase::AddOption(const COption& stOption)
     if (m_stError.IsCatch(ERROR_CODE_FLAG_REDEFINE))
     {
         char c = stOption.m_cShortName;
-        if (c != '\0' && FindOption(c) != nullptr)
+        if (c != '\0' && m_pSpec->FindOption(c) != nullptr)
         {
             m_stError.SetError(ERROR_CODE_FLAG_REDEFINE, std::string(1, c));
             return *this;
         }
     }
 
-    m_vecOptions.push_back(stOption);
+    CEnvSpec& stSpec = Setup();
+    int iIndex = stSpec.m_vecOptions.size();
+    stSpec.m_vecOptions.push_back(stOption);
+
+    // only index the first one if redefined option is not catched
+    const std::string& strLongName = stSpec.m_vecOptions.back().m_strLongName;
+    stSpec.m_stLongIndex.Insert(strLongName.c_str(), strLongName.size(), iIndex,
+            [&stSpec](int id) -> const std::string& { return stSpec.m_vecOptions[id].m_strLongName; });
+    unsigned char c = static_cast<unsigned char>(stOption.m_cShortName);
+    if (c != '\0' && stSpec.m_aShortIndex[c] == 0)
+    {
+        stSpec.m_aShortIndex[c] = iIndex + 1;
+    }
     return *this;
 }
 
-CEnvBase& CEnvBase::Flag(char cShortName, const std::string& strLongName, const std::string& strDescription)
+CEnvBase& CEnvBase::EnvPrefix(const std::string& strPrefix)
 {
-    COption stOption(cShortName, strLongName, strDescription);
-    return AddOption(stOption);
+    Setup().m_strEnvPrefix = strPrefix;
+    return *this;
 }
 
-CEnvBase& CEnvBase::Flag(char cShortName, const std::string& strLongName, const std::string& strDescription, bool& bBindValue)
+CEnvBase& CEnvBase::ConfigCache(const std::string& strCacheFile)
 {
-    COption stOption(cShortName, strLongName, strDescription);
-    Bind(strLongName, bBindValue);
-    return AddOption(stOption);
+    Setup().m_strConfigCache = strCacheFile;
+    return *this;
 }
 
-CEnvBase& CEnvBase::Option(char cShortName, const std::string& strLongName, const std::string& strDescription)
+CEnvBase& CEnvBase::ResponseFile(int nMaxDepth)
 {
-    COption stOption(cShortName, strLongName, strDescription);
-    stOption.m_bArgument = true;
-    return AddOption(stOption);
+    Setup().m_nResponseDepth = nMaxDepth;
+    return *this;
 }
 
-CEnvBase& CEnvBase::Option(char cShortName, const std::string& strLongName, const std::string& strDescription, const std::string& strDefault, int uBitorAttr /*= OPTION_ARGUMENT*/)
+CEnvBase& CEnvBase::StreamArgument(FArgumentHandler fnHandler)
 {
-    COption stOption(cShortName, strLongName, strDescription);
-    stOption.m_strDefault = strDefault;
-    stOption.m_bArgument = OPTION_ARGUMENT & uBitorAttr;
-    stOption.m_bRequired = OPTION_REQUIRED & uBitorAttr;
-    stOption.m_bRepeated = OPTION_REPEATED & uBitorAttr;
-    return AddOption(stOption);
+    CParseContext::StreamArgument(fnHandler);
+    return *this;
 }
 
-CEnvBase& CEnvBase::Required(char cShortName, const std::string& strLongName, const std::string& strDescription)
+void CParseContext::EnableStats(bool bEnable)
 {
-    COption stOption(cShortName, strLongName, strDescription);
-    stOption.m_bArgument = true;
-    stOption.m_bRequired = true;
-    return AddOption(stOption);
+    if (!bEnable)
+    {
+        m_pStats.reset();
+    }
+    else if (!m_pStats)
+    {
+        m_pStats.reset(new CParseStats);
+    }
+}
+
+CEnvBase& CEnvBase::EnableStats(bool bEnable)
+{
+    CParseContext::EnableStats(bEnable);
+    if (bEnable && m_pSpec->m_bFrozen && m_pSpec->m_iStatsOption < 0)
+    {
+        Freeze();
+    }
+    return *this;
+}
+
+void CEnvBase::PrintStats()
+{
+    if (m_pStats && m_stArgRecv.GetOption(m_pSpec->m_iStatsOption))
+    {
+        std::string text;
+        m_pStats->Format(text);
+        fprintf(stderr, "%s", text.c_str());
+    }
+}
+
+CEnvBase& CEnvBase::PublishSnapshot(bool bEnable)
+{
+    m_bPublish = bEnable;
+    return *this;
+}
+
+CEnvBase& CEnvBase::Declare(const CPerfectIndex& stIndex)
+{
+    if (!m_pSpec->m_vecOptions.empty())
+    {
+        for (size_t i = 0; i < stIndex.m_nDecl; ++i)
+        {
+            const COptionDecl& stDecl = stIndex.m_pDecl[i];
+            Option(stDecl.m_cShortName, stDecl.m_pLongName, stDecl.m_pDescription,
+                    stDecl.m_pDefault, stDecl.m_uAttr);
+        }
+        return *this;
+    }
+
+    // already checked redefined and invalid name at compile time, so only
+    // copy the fields, not insert long name to index as AddOption() does
+    CEnvSpec& stSpec = Setup();
+    stSpec.m_pPerfect = &stIndex;
+    stSpec.m_vecOptions.resize(stIndex.m_nDecl);
+    for (size_t i = 0; i < stIndex.m_nDecl; ++i)
+    {
+        const COptionDecl& stDecl = stIndex.m_pDecl[i];
+        COption& stOption = stSpec.m_vecOptions[i];
+        stOption.m_cShortName = stDecl.m_cShortName;
+        stOption.m_strLongName = stDecl.m_pLongName;
+        stOption.m_strDescription = stDecl.m_pDescription;
+        stOption.m_strDefault = stDecl.m_pDefault;
+        stOption.m_bArgument = OPTION_ARGUMENT & stDecl.m_uAttr;
+        stOption.m_bRequired = OPTION_REQUIRED & stDecl.m_uAttr;
+        stOption.m_bRepeated = OPTION_REPEATED & stDecl.m_uAttr;
+
+        unsigned char c = static_cast<unsigned char>(stDecl.m_cShortName);
+        if (c != '\0')
+        {
+            stSpec.m_aShortIndex[c] = i + 1;
+        }
+    }
+    return *this;
+}
+
+CEnvBase& CEnvBase::Flag(char cShortName, const std::string& strLongName, const std::string& strDescription)
+{
+    COption stOption(cShortName, strLongName, strDescription);
+    return AddOption(stOption);
+}
+
+CEnvBase& CEnvBase::Flag(char cShortName, const std::string& strLongName, const std::string& strDescription, bool& bBindValue)
+{
+    COption stOption(cShortName, strLongName, strDescription);
+    Bind(strLongName, bBindValue);
+    return AddOption(stOption);
+}
+
+CEnvBase& CEnvBase::Option(char cShortName, const std::string& strLongName, const std::string& strDescription)
+{
+    COption stOption(cShortName, strLongName, strDescription);
+    stOption.m_bArgument = true;
+    return AddOption(stOption);
+}
+
+CEnvBase& CEnvBase::Option(char cShortName, const std::string& strLongName, const std::string& strDescription, const std::string& strDefault, int uBitorAttr /*= OPTION_ARGUMENT*/)
+{
+    COption stOption(cShortName, strLongName, strDescription);
+    stOption.m_strDefault = strDefault;
+    stOption.m_bArgument = OPTION_ARGUMENT & uBitorAttr;
+    stOption.m_bRequired = OPTION_REQUIRED & uBitorAttr;
+    stOption.m_bRepeated = OPTION_REPEATED & uBitorAttr;
+    return AddOption(stOption);
+}
+
+CEnvBase& CEnvBase::Required(char cShortName, const std::string& strLongName, const std::string& strDescription)
+{
+    COption stOption(cShortName, strLongName, strDescription);
+    stOption.m_bArgument = true;
+    stOption.m_bRequired = true;
+    return AddOption(stOption);
 }
 
 CEnvBase& CEnvBase::Set(const std::string& strName, const std::string& strDescription)
@@ -743,368 +1666,1012 @@ CEnvBase& CEnvBase::Bind(const std::string& strOptionName, double& refVal)
     return *this;
 }
 
-CEnvBase& CEnvBase::Bind(const std::string& strOptionName, std::vector<std::string>& refVal)
+CEnvBase& CEnvBase::Bind(const std::string& strOptionName, int64_t& refVal)
 {
-    m_mapBind[strOptionName] = COptionBind(OPTION_STR_LIST, &refVal);
+    m_mapBind[strOptionName] = COptionBind(OPTION_INT64, &refVal);
     return *this;
 }
 
-CEnvBase& CEnvBase::Bind(const std::string& strOptionName, std::vector<int>& refVal)
-{
-    m_mapBind[strOptionName] = COptionBind(OPTION_INT_LIST, &refVal);
-    return *this;
-}
-CEnvBase& CEnvBase::Bind(const std::string& strOptionName, std::vector<double>& refVal)
+CEnvBase& CEnvBase::Bind(const std::string& strOptionName, uint64_t& refVal)
 {
-    m_mapBind[strOptionName] = COptionBind(OPTION_DOUBLE_LIST, &refVal);
+    m_mapBind[strOptionName] = COptionBind(OPTION_UINT64, &refVal);
     return *this;
 }
 
-void CEnvBase::GetBind()
-{
-    for (auto it = m_mapBind.begin(); it != m_mapBind.end(); ++it)
-    {
-        if (it->second.m_pBindValue == nullptr)
-        {
-            continue;
-        }
-
-        EOptionType eType = it->second.m_eValueType;
-        if (eType == OPTION_BOOL)
-        {
-            Get(it->first, *(static_cast<bool*>(it->second.m_pBindValue)));
-            continue;
-        }
-
-        std::string strArg = Get(it->first);
-        if (strArg.empty())
-        {
-            continue;
-        }
-
-        if (m_stError.IsCatch(ERROR_CODE_ARGTYPE_UNMATCH))
-        {
-            // only roughly detect int or double
-            if (eType == OPTION_INT || eType == OPTION_INT_LIST)
-            {
-                if (strArg.find_first_not_of("0123456789\0-", 0, 12) != std::string::npos)
-                {
-                    m_stError.SetError(ERROR_CODE_ARGTYPE_UNMATCH, strArg);
-                    return;
-                }
-            }
-            else if (eType == OPTION_DOUBLE || eType == OPTION_DOUBLE_LIST)
-            {
-                if (strArg.find_first_not_of("0123456789\0-.", 0, 13) != std::string::npos)
-                {
-                    m_stError.SetError(ERROR_CODE_ARGTYPE_UNMATCH, strArg);
-                    return;
-                }
-            }
-        }
-
-        if (eType == OPTION_STR)
-        {
-            *(static_cast<std::string*>(it->second.m_pBindValue)) = strArg;
-        }
-        else if (eType == OPTION_INT)
-        {
-            ConvertValue(strArg, *(static_cast<int*>(it->second.m_pBindValue)));
-        }
-        else if (eType == OPTION_DOUBLE)
-        {
-            ConvertValue(strArg, *(static_cast<double*>(it->second.m_pBindValue)));
-        }
-        else if (eType == OPTION_STR_LIST)
-        {
-            ConvertValue(strArg, *(static_cast<std::vector<std::string>*>(it->second.m_pBindValue)));
-        }
-        else if (eType == OPTION_INT_LIST)
-        {
-            ConvertValue(strArg, *(static_cast<std::vector<int>*>(it->second.m_pBindValue)));
-        }
-        else if (eType == OPTION_DOUBLE_LIST)
-        {
-            ConvertValue(strArg, *(static_cast<std::vector<double>*>(it->second.m_pBindValue)));
-        }
-    }
-}
-
-void CEnvBase::ClearArgument()
-{
-    m_stArgRecv.m_mapArgs.clear();
-    m_stArgRecv.m_vecArgs.clear();
-}
-
-void CEnvBase::ClearError()
-{
-    m_stError.SetError(0);
-}
-
-CEnvBase& CEnvBase::Catch(int code)
+CEnvBase& CEnvBase::Bind(const std::string& strOptionName, float& refVal)
 {
-    m_stError.CatchError(code);
+    m_mapBind[strOptionName] = COptionBind(OPTION_FLOAT, &refVal);
     return *this;
 }
 
-CEnvBase& CEnvBase::Catch(int* code, int size)
+CEnvBase& CEnvBase::Bind(const std::string& strOptionName, std::vector<std::string>& refVal, char cDelimiter)
 {
-    for (int i = 0; i < size; ++i)
-    {
-        m_stError.CatchError(code[i]);
-    }
+    m_mapBind[strOptionName] = COptionBind(OPTION_STR_LIST, &refVal, cDelimiter);
     return *this;
 }
 
-CEnvBase& CEnvBase::CatchAll()
+CEnvBase& CEnvBase::Bind(const std::string& strOptionName, std::vector<int>& refVal, char cDelimiter)
 {
-    for (int i = ERROR_CODE_HELP; i < ERROR_CODE_END; ++i)
-    {
-        m_stError.CatchError(i);
-    }
+    m_mapBind[strOptionName] = COptionBind(OPTION_INT_LIST, &refVal, cDelimiter);
     return *this;
 }
-
-CEnvBase& CEnvBase::Ignore(int code)
+CEnvBase& CEnvBase::Bind(const std::string& strOptionName, std::vector<double>& refVal, char cDelimiter)
 {
-    m_stError.IgnoreError(code);
+    m_mapBind[strOptionName] = COptionBind(OPTION_DOUBLE_LIST, &refVal, cDelimiter);
     return *this;
 }
 
-CEnvBase& CEnvBase::Ignore(int* code, int size)
+// convert and validate number in one pass, return util::ENumberParse
+static int ConvertNumber(EOptionType eType, void* pBindValue, const util::CStrView& strArg)
 {
-    for (int i = 0; i < size; ++i)
+    switch (eType)
     {
-        m_stError.IgnoreError(code[i]);
+    case OPTION_INT:
+        return util::ParseNumber(strArg, *static_cast<int*>(pBindValue));
+    case OPTION_INT64:
+        return util::ParseNumber(strArg, *static_cast<int64_t*>(pBindValue));
+    case OPTION_UINT64:
+        return util::ParseNumber(strArg, *static_cast<uint64_t*>(pBindValue));
+    case OPTION_DOUBLE:
+        return util::ParseNumber(strArg, *static_cast<double*>(pBindValue));
+    case OPTION_FLOAT:
+        return util::ParseNumber(strArg, *static_cast<float*>(pBindValue));
+    default:
+        break;
     }
-    return *this;
+    return util::NUMBER_INVALID;
 }
 
-COption* CEnvBase::FindOption(char cShortName)
+template <typename valueT>
+int CEnvBase::BindList(const std::string& strOptionName, std::vector<valueT>& vecBind, char cDelimiter, util::CStrView& strError)
 {
-    for (auto it = m_vecOptions.begin(); it != m_vecOptions.end(); ++it)
+    // append to bound list directly, restore it if any invalid
+    int iRet = 0;
+    size_t nOrigin = vecBind.size();
+    EachValue(strOptionName, [&iRet, &vecBind, cDelimiter, &strError](const util::CStrView& strArg)
     {
-        if (it->m_cShortName == cShortName)
+        if (iRet != 0)
+        {
+            return;
+        }
+        int iItem = 0;
+        if (cDelimiter != '\0')
         {
-            return &(*it);
+            iItem = util::SplitNumber(strArg, vecBind, cDelimiter);
         }
+        else
+        {
+            valueT value = 0;
+            iItem = util::ParseNumber(strArg, value);
+            vecBind.push_back(value);
+        }
+        if (iItem != 0)
+        {
+            iRet = iItem;
+            strError = strArg;
+        }
+    });
+    if (iRet != 0)
+    {
+        vecBind.resize(nOrigin);
     }
-    return nullptr;
+    return iRet;
 }
 
-COption* CEnvBase::FindOption(const std::string& strLongName)
+void CEnvBase::OnReceived()
 {
-    for (auto it = m_vecOptions.begin(); it != m_vecOptions.end(); ++it)
+    for (auto it = m_mapBind.begin(); it != m_mapBind.end(); ++it)
     {
-        if (it->m_strLongName == strLongName)
+        if (!BindValue(it->first, it->second))
         {
-            return &(*it);
+            return;
         }
     }
-    return nullptr;
 }
 
-CommandInfo* CEnvBase::FindCommand(const std::string& strName)
+bool CEnvBase::BindValue(const std::string& strOptionName, const COptionBind& stBind)
 {
-    for (size_t i = 0; i < m_vecCommand.size(); ++i)
+    void* pBindValue = stBind.m_pBindValue;
+    if (pBindValue == nullptr)
     {
-        if (m_vecCommand[i].m_strName == strName)
+        return true;
+    }
+
+    EOptionType eType = stBind.m_eValueType;
+    if (eType == OPTION_BOOL)
+    {
+        Get(strOptionName, *(static_cast<bool*>(pBindValue)));
+        return true;
+    }
+    if (eType == OPTION_STR)
+    {
+        std::string strArg = Get(strOptionName);
+        if (!strArg.empty())
         {
-            return &(m_vecCommand[i]);
+            *(static_cast<std::string*>(pBindValue)) = strArg;
         }
+        return true;
     }
-    return nullptr;
-}
-
-CommandInfo* CEnvBase::FindCommand(int argc, const char* argv[], int& iShift)
-{
-    if (m_vecCommand.empty())
+    if (eType == OPTION_STR_LIST)
     {
-        return nullptr;
+        Get(strOptionName, *(static_cast<std::vector<std::string>*>(pBindValue)), stBind.m_cDelimiter);
+        return true;
     }
 
-    CommandInfo* pSubCommand = nullptr;
-    if (1 < argc && argv[1] != nullptr)
+    int iRet = 0;
+    util::CStrView strArg;
+    if (eType == OPTION_INT_LIST)
     {
-        pSubCommand = FindCommand(argv[1]);
-        if (pSubCommand != nullptr)
+        iRet = BindList(strOptionName, *(static_cast<std::vector<int>*>(pBindValue)), stBind.m_cDelimiter, strArg);
+    }
+    else if (eType == OPTION_DOUBLE_LIST)
+    {
+        iRet = BindList(strOptionName, *(static_cast<std::vector<double>*>(pBindValue)), stBind.m_cDelimiter, strArg);
+    }
+    else
+    {
+        strArg = Lookup(strOptionName);
+        if (strArg.empty())
         {
-            iShift = 1;
+            return true;
         }
+        iRet = ConvertNumber(eType, pBindValue, strArg);
     }
-    if (pSubCommand == nullptr)
+
+    if (iRet == util::NUMBER_INVALID && m_stError.IsCatch(ERROR_CODE_ARGTYPE_UNMATCH))
     {
-        pSubCommand = FindCommand(argv[0]);
+        m_stError.SetError(ERROR_CODE_ARGTYPE_UNMATCH, strArg.ToString());
+        return false;
     }
-    if (pSubCommand == nullptr)
+    if (iRet == util::NUMBER_OVERFLOW && m_stError.IsCatch(ERROR_CODE_ARGUMENT_OVERFLOW))
     {
-        pSubCommand = FindCommand(program_invocation_short_name);
+        m_stError.SetError(ERROR_CODE_ARGUMENT_OVERFLOW, strArg.ToString());
+        return false;
     }
-
-    return pSubCommand;
+    return true;
 }
 
-void CEnvBase::SaveArgument(const std::string& strArg)
+bool CEnvBase::CheckBindValue(const std::string& strOptionName, const COptionBind& stBind)
 {
-    m_stArgRecv.m_vecArgs.push_back(strArg);
-}
+    if (stBind.m_pBindValue == nullptr)
+    {
+        return true;
+    }
 
-void CEnvBase::SaveOption(char cShortName)
-{
-    std::string strShortName(1, cShortName);
-    m_stArgRecv.m_mapArgs[strShortName] = "1";
+    // convert to a scratch of the same type, string and bool never fail
+    union
+    {
+        int iValue;
+        int64_t lValue;
+        uint64_t uValue;
+        double dValue;
+        float fValue;
+    } uScratch;
+    std::vector<int> vecInt;
+    std::vector<double> vecDouble;
+    void* pScratch = &uScratch;
+    switch (stBind.m_eValueType)
+    {
+    case OPTION_BOOL:
+    case OPTION_STR:
+    case OPTION_STR_LIST:
+        return true;
+    case OPTION_INT_LIST:
+        pScratch = &vecInt;
+        break;
+    case OPTION_DOUBLE_LIST:
+        pScratch = &vecDouble;
+        break;
+    default:
+        break;
+    }
+    return BindValue(strOptionName, COptionBind(stBind.m_eValueType, pScratch, stBind.m_cDelimiter));
 }
 
-void CEnvBase::SaveOption(const std::string& strLongName, const std::string& strArg)
+void CEnvBase::ResetBindValue(const COptionBind& stBind)
 {
-    if (m_stArgRecv.m_mapArgs.count(strLongName) == 0)
+    void* pBindValue = stBind.m_pBindValue;
+    if (pBindValue == nullptr)
+    {
+        return;
+    }
+
+    switch (stBind.m_eValueType)
     {
-        m_stArgRecv.m_mapArgs[strLongName] = strArg;
+    case OPTION_BOOL:
+        *static_cast<bool*>(pBindValue) = false;
+        break;
+    case OPTION_STR:
+        static_cast<std::string*>(pBindValue)->clear();
+        break;
+    case OPTION_INT:
+        *static_cast<int*>(pBindValue) = 0;
+        break;
+    case OPTION_DOUBLE:
+        *static_cast<double*>(pBindValue) = 0;
+        break;
+    case OPTION_INT64:
+        *static_cast<int64_t*>(pBindValue) = 0;
+        break;
+    case OPTION_UINT64:
+        *static_cast<uint64_t*>(pBindValue) = 0;
+        break;
+    case OPTION_FLOAT:
+        *static_cast<float*>(pBindValue) = 0;
+        break;
+    case OPTION_STR_LIST:
+        static_cast<std::vector<std::string>*>(pBindValue)->clear();
+        break;
+    case OPTION_INT_LIST:
+        static_cast<std::vector<int>*>(pBindValue)->clear();
+        break;
+    case OPTION_DOUBLE_LIST:
+        static_cast<std::vector<double>*>(pBindValue)->clear();
+        break;
     }
 }
 
-void CEnvBase::SaveOption(const COption& stOption)
+/// count of SIGHUP received, shared by all watcher
+static volatile sig_atomic_t s_nSighup = 0;
+
+static void OnSighup(int)
 {
-    assert(!stOption.m_bArgument);
-    m_stArgRecv.m_mapArgs[stOption.m_strLongName] = "1";
+    s_nSighup = s_nSighup + 1;
 }
 
-void CEnvBase::SaveOption(const COption& stOption, const std::string& strArg)
+int CEnvBase::WatchConfig(FConfigChanged fnChanged)
 {
-    assert(stOption.m_bArgument);
-    if (!stOption.m_bRepeated)
+    m_fnConfigChanged = fnChanged;
+
+    static std::once_flag s_onceSignal;
+    std::call_once(s_onceSignal, []()
     {
-        if (m_stArgRecv.m_mapArgs.count(stOption.m_strLongName) == 0)
-        {
-            m_stArgRecv.m_mapArgs[stOption.m_strLongName] = strArg;
-        }
+        struct sigaction stAction;
+        memset(&stAction, 0, sizeof(stAction));
+        stAction.sa_handler = OnSighup;
+        sigemptyset(&stAction.sa_mask);
+        stAction.sa_flags = SA_RESTART;
+        sigaction(SIGHUP, &stAction, nullptr);
+    });
+    m_nSighupSeen = s_nSighup;
+
+    if (m_fdWatch >= 0)
+    {
+        close(m_fdWatch);
+        m_fdWatch = -1;
     }
-    else
+    std::string strFile = Lookup(OPTION_NAME_CONFIG).ToString();
+    if (strFile.empty() || strFile == "NONE")
     {
-        std::string& strOldArg = m_stArgRecv.m_mapArgs[stOption.m_strLongName];
-        if (!strOldArg.empty())
-        {
-            strOldArg.append(1, '\0');
-        }
-        strOldArg.append(strArg);
+        return -1;
     }
-}
 
-bool CEnvBase::CheckOptionArgument(const std::string& strArg)
-{
-    if (m_stError.IsCatch(ERROR_CODE_ARGUMENT_INVALID) && IsInvalidArgument(strArg))
+    // watch the directory, as editor may replace the file by rename
+    size_t iSlash = strFile.rfind('/');
+    std::string strDir = iSlash == std::string::npos ? "." : strFile.substr(0, iSlash + 1);
+    m_strWatchName = iSlash == std::string::npos ? strFile : strFile.substr(iSlash + 1);
+    m_fdWatch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fdWatch >= 0 && inotify_add_watch(m_fdWatch, strDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
     {
-        m_stError.SetError(ERROR_CODE_ARGUMENT_INVALID, strArg);
-        return false;
+        close(m_fdWatch);
+        m_fdWatch = -1;
     }
-    return true;
+    return m_fdWatch;
 }
 
-bool CEnvBase::CheckRequiredOption()
+int CEnvBase::CheckConfig()
 {
-    int nCount = 0;
-    for (auto it = m_vecOptions.begin(); it != m_vecOptions.end(); ++it)
+    bool bChanged = false;
+    int nSighup = s_nSighup;
+    if (nSighup != m_nSighupSeen)
+    {
+        m_nSighupSeen = nSighup;
+        bChanged = true;
+    }
+
+    if (m_fdWatch >= 0)
     {
-        if (it->m_bRequired && m_stArgRecv.m_mapArgs.count(it->m_strLongName) == 0)
+        alignas(struct inotify_event) char szEvent[4096];
+        ssize_t nRead = 0;
+        while ((nRead = read(m_fdWatch, szEvent, sizeof(szEvent))) > 0)
         {
-            m_stError.SetError(ERROR_CODE_OPTION_REQUIRED, it->m_strLongName);
-            return false;
+            for (char* p = szEvent; p < szEvent + nRead; )
+            {
+                struct inotify_event* pEvent = reinterpret_cast<struct inotify_event*>(p);
+                if (pEvent->len > 0 && m_strWatchName == pEvent->name)
+                {
+                    bChanged = true;
+                }
+                p += sizeof(struct inotify_event) + pEvent->len;
+            }
         }
     }
-    return true;
+
+    return bChanged ? ReloadConfig() : 0;
 }
 
-bool CEnvBase::CheckUnknownOption()
+/// copy a value to another argument, the value from argv is still referred.
+static CArgValue CopyValue(const CArgument& stFrom, const CArgValue& stValue, CArgument& stTo)
 {
-    for (auto it = m_stArgRecv.m_mapArgs.begin(); it != m_stArgRecv.m_mapArgs.end(); ++it)
+    if (stValue.m_pExtern != nullptr)
     {
-        if (nullptr == FindOption(it->first))
-        {
-            m_stError.SetError(ERROR_CODE_OPTION_UNKNOWN, it->first);
-            return false;
-        }
+        return CArgument::Refer(stFrom.View(stValue));
     }
-    return true;
+    return stTo.Keep(stFrom.View(stValue));
 }
 
-void CEnvBase::MoveArgument()
+int CEnvBase::ReloadConfig()
 {
-    if (m_stArgRecv.m_vecArgs.empty())
+    std::string strFile = Lookup(OPTION_NAME_CONFIG).ToString();
+    if (strFile.empty() || strFile == "NONE")
     {
-        return;
+        return 0;
     }
-
-    size_t nSize = m_stArgRecv.m_vecArgs.size();
-    if (nSize > m_vecOptions.size())
+    CParseContext stConfig(Share());
+    int iRet = stConfig.FeedConfig(strFile);
+    if (iRet != 0)
     {
-        nSize = m_vecOptions.size();
+        return iRet;
     }
 
-    // collect COption* whose m_iBindIndex is set
-    int iMaxIndex = 0;
-    std::vector<COption*> vecOptions(nSize, nullptr);
-    for (auto it = m_vecOptions.begin(); it != m_vecOptions.end(); ++it)
+    // rebuild the received result, so repeated reload won't grow the buffer
+    const CArgument& stNew = stConfig.GetArgument();
+    size_t nOption = m_pSpec->m_vecOptions.size();
+    CArgument stMerged;
+    stMerged.Clear(nOption);
+    std::vector<std::string> vecChanged;
+    std::vector<bool> vecChangedId(nOption, false);
+    for (size_t i = 0; i < nOption; ++i)
     {
-        if (it->m_iBindIndex == 0)
-        {
-            continue;
-        }
-        if (it->m_iBindIndex > 0 && it->m_iBindIndex <= nSize)
+        bool bChanged = false;
+        if (i >= m_vecCmdline.size() || !m_vecCmdline[i])
         {
-            if (vecOptions[it->m_iBindIndex - 1] != nullptr && m_stError.IsCatch(ERROR_CODE_POSITION_BIND))
+            const CArgValue* pOld = m_stArgRecv.GetOption(i);
+            const CArgValue* pNew = stNew.GetOption(i);
+            while (pOld != nullptr && pNew != nullptr && m_stArgRecv.View(*pOld) == stNew.View(*pNew))
             {
-                std::string strText = "redefined of ";
-                strText.append(it->m_strLongName).append("#").append(std::to_string(it->m_iBindIndex));
-                m_stError.SetError(ERROR_CODE_POSITION_BIND, strText);
-                return;
+                pOld = m_stArgRecv.Next(pOld);
+                pNew = stNew.Next(pNew);
             }
+            bChanged = pOld != nullptr || pNew != nullptr;
+        }
 
-            vecOptions[it->m_iBindIndex - 1] = &(*it);
-            if (iMaxIndex < it->m_iBindIndex)
-            {
-                iMaxIndex = it->m_iBindIndex;
-            }
+        const CArgument& stFrom = bChanged ? stNew : m_stArgRecv;
+        for (const CArgValue* pValue = stFrom.GetOption(i); pValue != nullptr; pValue = stFrom.Next(pValue))
+        {
+            stMerged.Append(stMerged.m_vecOption[i], CopyValue(stFrom, *pValue, stMerged));
         }
-        else if(m_stError.IsCatch(ERROR_CODE_POSITION_BIND))
+        if (bChanged)
         {
-            std::string strText = "beyond range of ";
-            strText.append(it->m_strLongName).append("#").append(std::to_string(it->m_iBindIndex));
-            m_stError.SetError(ERROR_CODE_POSITION_BIND, strText);
-            return;
+            vecChanged.push_back(m_pSpec->m_vecOptions[i].m_strLongName);
+            vecChangedId[i] = true;
         }
     }
 
-    if(m_stError.IsCatch(ERROR_CODE_POSITION_BIND))
+    if (vecChanged.empty())
     {
-        for (int i = iMaxIndex - 1; i >= 0; --i)
-        {
-            if (vecOptions[i-1] == nullptr)
-            {
-                std::string strText = "no preposition bound index #";
-                strText += std::to_string(i);
-                m_stError.SetError(ERROR_CODE_POSITION_BIND, strText);
-                return;
-            }
-        }
+        return 0;
     }
 
-    // move from #1 #2 ... in order
-    size_t nMoved = 0;
-    for (auto it = vecOptions.begin(); it != vecOptions.end(); ++it)
+    for (auto it = m_stArgRecv.m_vecUnknown.begin(); it != m_stArgRecv.m_vecUnknown.end(); ++it)
+    {
+        CArgUnknown stUnknown;
+        stUnknown.m_stName = CopyValue(m_stArgRecv, it->m_stName, stMerged);
+        stUnknown.m_iValue = stMerged.m_vecValue.size();
+        stMerged.m_vecValue.push_back(CopyValue(m_stArgRecv, m_stArgRecv.m_vecValue[it->m_iValue], stMerged));
+        util::CStrView strName = stMerged.View(stUnknown.m_stName);
+        stMerged.m_vecUnknown.push_back(stUnknown);
+        stMerged.m_stUnknownIndex.Insert(strName.data(), strName.size(), stMerged.m_vecUnknown.size() - 1,
+                [&stMerged](int id) { return stMerged.View(stMerged.m_vecUnknown[id].m_stName); });
+    }
+    for (auto it = m_stArgRecv.m_vecArgs.begin(); it != m_stArgRecv.m_vecArgs.end(); ++it)
+    {
+        stMerged.m_vecArgs.push_back(CopyValue(m_stArgRecv, *it, stMerged));
+    }
+
+    // expire Args() and typed Get<T>() cache
+    std::swap(m_stArgRecv, stMerged);
+    m_bArgsCopied = false;
+    m_nFeed++;
+
+    // bound by short name or long name, compare by option id
+    std::vector<std::map<std::string, COptionBind>::iterator> vecRebind;
+    for (auto it = m_mapBind.begin(); it != m_mapBind.end(); ++it)
     {
-        if (*it == nullptr)
+        int iOption = OptionId(it->first);
+        if (iOption < 0 && it->first.size() == 1)
         {
-            break;
+            iOption = m_pSpec->OptionId(it->first[0]);
         }
-        if (!Has((*it)->m_strLongName))
+        if (iOption >= 0 && iOption < (int)nOption && vecChangedId[iOption])
         {
-            SaveOption(**it, m_stArgRecv.m_vecArgs[nMoved]);
-            nMoved++;
+            vecRebind.push_back(it);
         }
-        else
+    }
+
+    // check all changed values before any bound variable is written
+    for (auto it = vecRebind.begin(); it != vecRebind.end(); ++it)
+    {
+        if (!CheckBindValue((*it)->first, (*it)->second))
+        {
+            std::swap(m_stArgRecv, stMerged);
+            m_nFeed++;
+            return m_stError.Code();
+        }
+    }
+
+    // removed option without default is reset, and list is bound from empty
+    for (auto it = vecRebind.begin(); it != vecRebind.end(); ++it)
+    {
+        ResetBindValue((*it)->second);
+        BindValue((*it)->first, (*it)->second);
+    }
+
+    if (m_bPublish)
+    {
+        m_stPublisher.Publish(MakeSnapshot());
+    }
+    if (m_fnConfigChanged)
+    {
+        m_fnConfigChanged(vecChanged);
+    }
+    return 0;
+}
+
+const std::map<std::string, std::string>& CParseContext::Args()
+{
+    if (!m_bArgsCopied)
+    {
+        m_mapArgsCopy.clear();
+        for (size_t i = 0; i < m_stArgRecv.m_vecOption.size() && i < m_pSpec->m_vecOptions.size(); ++i)
+        {
+            const CArgValue* pValue = m_stArgRecv.GetOption(i);
+            if (pValue != nullptr)
+            {
+                m_mapArgsCopy[m_pSpec->m_vecOptions[i].m_strLongName] = JoinValue(m_stArgRecv, pValue);
+            }
+        }
+        for (auto it = m_stArgRecv.m_vecUnknown.begin(); it != m_stArgRecv.m_vecUnknown.end(); ++it)
+        {
+            m_mapArgsCopy[m_stArgRecv.View(it->m_stName).ToString()] =
+                m_stArgRecv.View(m_stArgRecv.m_vecValue[it->m_iValue]).ToString();
+        }
+        m_bArgsCopied = true;
+    }
+    return m_mapArgsCopy;
+}
+
+const std::vector<std::string>& CParseContext::Argv()
+{
+    if (!m_bArgvCopied)
+    {
+        m_vecArgsCopy.clear();
+        for (auto it = m_stArgRecv.m_vecArgs.begin(); it != m_stArgRecv.m_vecArgs.end(); ++it)
+        {
+            m_vecArgsCopy.push_back(m_stArgRecv.View(*it).ToString());
+        }
+        m_bArgvCopied = true;
+    }
+    return m_vecArgsCopy;
+}
+
+void CParseContext::ClearArgument()
+{
+    m_stArgRecv.Clear(m_pSpec->m_vecOptions.size());
+    m_bArgsCopied = false;
+    m_bArgvCopied = false;
+    m_nFeed++;
+}
+
+std::unique_ptr<CParseContext::CCachedValue>& CParseContext::CacheSlot(const std::string& strOptionName)
+{
+    int iOption = OptionId(strOptionName);
+    if (iOption < 0)
+    {
+        return m_mapCache[strOptionName];
+    }
+    if (static_cast<size_t>(iOption) >= m_vecCache.size())
+    {
+        m_vecCache.resize(m_pSpec->m_vecOptions.size());
+    }
+    return m_vecCache[iOption];
+}
+
+void CParseContext::ClearError()
+{
+    m_stError.SetError(0);
+}
+
+size_t CParseContext::FeedBatch(const std::vector<std::string>& vecLines, CBatchResult& stResult)
+{
+    auto it = vecLines.begin();
+    return FeedBatch([&it, &vecLines](util::CStrView& strLine)
+    {
+        if (it == vecLines.end())
+        {
+            return false;
+        }
+        strLine = *it++;
+        return true;
+    }, stResult);
+}
+
+size_t CParseContext::FeedBatch(const FArgSource& fnLine, CBatchResult& stResult)
+{
+    const CEnvSpec& stSpec = *m_pSpec;
+    if (stResult.m_pSpec != m_pSpec)
+    {
+        stResult.Clear();
+        stResult.m_pSpec = m_pSpec;
+        stResult.m_vecColumn.resize(stSpec.m_vecOptions.size());
+    }
+
+    LoadEnvironment();
+    stResult.m_vecFallback.resize(stSpec.m_vecOptions.size());
+    for (size_t i = 0; i < stSpec.m_vecOptions.size(); ++i)
+    {
+        util::CStrView strEnv = EnvValue(i);
+        stResult.m_vecFallback[i] = strEnv.empty() ? stSpec.m_vecOptions[i].m_strDefault : strEnv.ToString();
+    }
+
+    size_t nLine = 0;
+    util::CStrView strLine;
+    std::string strQuoted;
+    while (fnLine(strLine))
+    {
+        ParseBatchLine(strLine, strQuoted);
+        SaveBatchLine(stResult);
+        ClearError();
+        nLine++;
+    }
+    return nLine;
+}
+
+void CParseContext::ParseBatchLine(const util::CStrView& strLine, std::string& strQuoted)
+{
+    ClearArgument();
+    if (m_stArgRecv.m_vecOption.size() < m_pSpec->m_vecOptions.size())
+    {
+        m_stArgRecv.m_vecOption.resize(m_pSpec->m_vecOptions.size());
+    }
+
+    // the line lives until saved to batch result, only keep quoted token
+    bool bKeepToken = m_bKeepToken;
+    m_nArgMoved = 0;
+    m_bArgMoving = true;
+    CParseState stState;
+    size_t iPos = 0;
+    util::CStrView strToken;
+    int iRet = 0;
+    while (iRet == 0 && util::NextToken(strLine, iPos, strToken, strQuoted))
+    {
+        m_bKeepToken = strToken.data() == strQuoted.data();
+        iRet = ParseToken(strToken, stState);
+    }
+    m_bKeepToken = bKeepToken;
+    m_bArgMoving = false;
+    if (iRet != 0 || FinishParse(stState) != 0)
+    {
+        return;
+    }
+
+    MoveArgument();
+    if (!CheckRequiredOption())
+    {
+        return;
+    }
+    if (m_stError.IsCatch(ERROR_CODE_OPTION_UNKNOWN))
+    {
+        CheckUnknownOption();
+    }
+}
+
+void CParseContext::SaveBatchLine(CBatchResult& stResult)
+{
+    std::string& strBuffer = stResult.m_strBuffer;
+    for (size_t i = 0; i < stResult.m_vecColumn.size(); ++i)
+    {
+        CBatchResult::CSpan stSpan;
+        const CArgValue* pValue = m_stArgRecv.GetOption(i);
+        if (pValue != nullptr)
+        {
+            stSpan.m_iOffset = strBuffer.size();
+            for (const CArgValue* pFirst = pValue; pValue != nullptr; pValue = m_stArgRecv.Next(pValue))
+            {
+                if (pValue != pFirst)
+                {
+                    strBuffer.push_back('\0');
+                }
+                util::CStrView strValue = m_stArgRecv.View(*pValue);
+                strBuffer.append(strValue.data(), strValue.size());
+            }
+            stSpan.m_nSize = strBuffer.size() - stSpan.m_iOffset;
+        }
+        stResult.m_vecColumn[i].push_back(stSpan);
+    }
+
+    for (auto it = m_stArgRecv.m_vecArgs.begin(); it != m_stArgRecv.m_vecArgs.end(); ++it)
+    {
+        util::CStrView strArg = m_stArgRecv.View(*it);
+        CBatchResult::CSpan stSpan;
+        stSpan.m_iOffset = strBuffer.size();
+        stSpan.m_nSize = strArg.size();
+        strBuffer.append(strArg.data(), strArg.size());
+        stResult.m_vecArgs.push_back(stSpan);
+    }
+    stResult.m_vecArgIndex.push_back(stResult.m_vecArgs.size());
+    stResult.m_vecError.push_back(m_stError.Code());
+}
+
+int CBatchResult::OptionId(const std::string& strOptionName) const
+{
+    if (!m_pSpec)
+    {
+        return -1;
+    }
+    int iOption = m_pSpec->OptionId(strOptionName);
+    if (iOption < 0 && strOptionName.size() == 1)
+    {
+        iOption = m_pSpec->OptionId(strOptionName[0]);
+    }
+    return iOption;
+}
+
+bool CBatchResult::Has(size_t iLine, int iOption) const
+{
+    return iOption >= 0 && iOption < (int)m_vecColumn.size() && iLine < Lines()
+        && m_vecColumn[iOption][iLine].m_iOffset != SPAN_ABSENT;
+}
+
+util::CStrView CBatchResult::Get(size_t iLine, int iOption) const
+{
+    if (iOption < 0 || iOption >= (int)m_vecColumn.size() || iLine >= Lines())
+    {
+        return util::CStrView();
+    }
+    const CSpan& stSpan = m_vecColumn[iOption][iLine];
+    if (stSpan.m_iOffset == SPAN_ABSENT)
+    {
+        return m_vecFallback[iOption];
+    }
+    return View(stSpan);
+}
+
+util::CStrView CBatchResult::Arg(size_t iLine, size_t pos) const
+{
+    size_t nArgc = Argc(iLine);
+    if (pos == 0 || pos > nArgc)
+    {
+        return util::CStrView();
+    }
+    return View(m_vecArgs[m_vecArgIndex[iLine] + pos - 1]);
+}
+
+void CBatchResult::Clear()
+{
+    m_strBuffer.clear();
+    for (auto it = m_vecColumn.begin(); it != m_vecColumn.end(); ++it)
+    {
+        it->clear();
+    }
+    m_vecArgs.clear();
+    m_vecArgIndex.assign(1, 0);
+    m_vecError.clear();
+}
+
+std::shared_ptr<CArgSnapshot> CParseContext::MakeSnapshot()
+{
+    std::shared_ptr<CArgSnapshot> pSnapshot = std::make_shared<CArgSnapshot>();
+    pSnapshot->m_pSpec = m_pSpec;
+    pSnapshot->m_vecValue.resize(m_pSpec->m_vecOptions.size());
+    for (size_t i = 0; i < m_pSpec->m_vecOptions.size(); ++i)
+    {
+        CArgSnapshot::CSnapValue& stValue = pSnapshot->m_vecValue[i];
+        stValue.m_bHas = m_stArgRecv.GetOption(i) != nullptr;
+        stValue.m_strValue = Get(m_pSpec->m_vecOptions[i].m_strLongName);
+    }
+
+    // the first value of unknown option as Get() does
+    for (auto it = m_stArgRecv.m_vecUnknown.begin(); it != m_stArgRecv.m_vecUnknown.end(); ++it)
+    {
+        std::string strName = m_stArgRecv.View(it->m_stName).ToString();
+        CArgSnapshot::CSnapValue& stValue = pSnapshot->m_mapOther[strName];
+        if (!stValue.m_bHas)
+        {
+            stValue.m_bHas = true;
+            stValue.m_strValue = Get(strName);
+        }
+    }
+    for (auto it = m_mapEnvImport.begin(); it != m_mapEnvImport.end(); ++it)
+    {
+        if (pSnapshot->m_mapOther.count(it->first) == 0)
+        {
+            pSnapshot->m_mapOther[it->first].m_strValue = it->second;
+        }
+    }
+
+    pSnapshot->m_vecArgs = Argv();
+    pSnapshot->m_strArgsJoin = Get("--");
+    return pSnapshot;
+}
+
+const CArgSnapshot::CSnapValue* CArgSnapshot::FindValue(const std::string& strOptionName) const
+{
+    int iOption = m_pSpec->OptionId(strOptionName);
+    if (iOption < 0 && strOptionName.size() == 1)
+    {
+        iOption = m_pSpec->OptionId(strOptionName[0]);
+    }
+    if (iOption >= 0)
+    {
+        return &m_vecValue[iOption];
+    }
+    auto it = m_mapOther.find(strOptionName);
+    return it == m_mapOther.end() ? nullptr : &it->second;
+}
+
+bool CArgSnapshot::Has(const std::string& strOptionName) const
+{
+    const CSnapValue* pValue = FindValue(strOptionName);
+    return pValue != nullptr && pValue->m_bHas;
+}
+
+const std::string& CArgSnapshot::Get(const std::string& strOptionName) const
+{
+    static const std::string s_strEmpty;
+    if (strOptionName == "--")
+    {
+        return m_strArgsJoin;
+    }
+    const CSnapValue* pValue = FindValue(strOptionName);
+    return pValue == nullptr ? s_strEmpty : pValue->m_strValue;
+}
+
+const std::string& CArgSnapshot::Get(size_t pos) const
+{
+    static const std::string s_strEmpty;
+    if (pos == 0)
+    {
+        return m_strArgsJoin;
+    }
+    return pos > m_vecArgs.size() ? s_strEmpty : m_vecArgs[pos - 1];
+}
+
+void CSnapshotPublisher::Publish(std::shared_ptr<CArgSnapshot> pSnapshot)
+{
+    // single writer, the version is increased after the pointer is stored,
+    // so that reader seeing new version must load the new snapshot
+    uint64_t uVersion = m_uVersion.load(std::memory_order_relaxed) + 1;
+    pSnapshot->m_uVersion = uVersion;
+    std::atomic_store(&m_pCurrent, std::shared_ptr<const CArgSnapshot>(std::move(pSnapshot)));
+    m_uVersion.store(uVersion, std::memory_order_release);
+}
+
+CEnvBase& CEnvBase::Catch(int code)
+{
+    m_stError.CatchError(code);
+    return *this;
+}
+
+CEnvBase& CEnvBase::Catch(int* code, int size)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        m_stError.CatchError(code[i]);
+    }
+    return *this;
+}
+
+CEnvBase& CEnvBase::CatchAll()
+{
+    for (int i = ERROR_CODE_HELP; i < ERROR_CODE_END; ++i)
+    {
+        m_stError.CatchError(i);
+    }
+    return *this;
+}
+
+CEnvBase& CEnvBase::Ignore(int code)
+{
+    m_stError.IgnoreError(code);
+    return *this;
+}
+
+CEnvBase& CEnvBase::Ignore(int* code, int size)
+{
+    for (int i = 0; i < size; ++i)
+    {
+        m_stError.IgnoreError(code[i]);
+    }
+    return *this;
+}
+
+CommandInfo* CEnvBase::FindCommand(const util::CStrView& strName)
+{
+    int iCommand = m_stCommandIndex.Find(strName.data(), strName.size(),
+            [this](int id) -> const std::string& { return m_vecCommand[id].m_strName; });
+    return iCommand < 0 ? nullptr : &(m_vecCommand[iCommand]);
+}
+
+CommandInfo* CEnvBase::FindCommand(int argc, const char* argv[], int& iShift)
+{
+    if (m_vecCommand.empty())
+    {
+        return nullptr;
+    }
+
+    CommandInfo* pSubCommand = nullptr;
+    if (1 < argc && argv[1] != nullptr)
+    {
+        pSubCommand = FindCommand(argv[1]);
+        if (pSubCommand != nullptr)
+        {
+            iShift = 1;
+            return pSubCommand;
+        }
+    }
+
+    util::CStrView strProgram(argv[0]);
+    pSubCommand = FindCommand(strProgram);
+    if (pSubCommand != nullptr)
+    {
+        return pSubCommand;
+    }
+    const char* pSlash = strrchr(argv[0], '/');
+    if (pSlash != nullptr)
+    {
+        strProgram = util::CStrView(pSlash + 1);
+        pSubCommand = FindCommand(strProgram);
+        if (pSubCommand != nullptr)
+        {
+            return pSubCommand;
+        }
+    }
+    if (strProgram != program_invocation_short_name)
+    {
+        pSubCommand = FindCommand(program_invocation_short_name);
+    }
+
+    return pSubCommand;
+}
+
+CArgValue CParseContext::MakeValue(const util::CStrView& strArg)
+{
+    if (!m_bKeepToken)
+    {
+        return CArgument::Refer(strArg);
+    }
+    if (m_pStats)
+    {
+        m_pStats->m_nCopyBytes += strArg.size();
+    }
+    return m_stArgRecv.Keep(strArg);
+}
+
+void CParseContext::SaveArgument(const util::CStrView& strArg)
+{
+    if (!m_fnArgument)
+    {
+        m_stArgRecv.m_vecArgs.push_back(MakeValue(strArg));
+        return;
+    }
+
+    // streaming mode, move the leading argument now as MoveArgument()
+    if (m_bArgMoving && m_nArgMoved < m_pSpec->m_vecBindPos.size())
+    {
+        int iOption = m_pSpec->m_vecBindPos[m_nArgMoved];
+        if (m_stArgRecv.GetOption(iOption) == nullptr)
+        {
+            SaveValue(m_pSpec->m_vecOptions[iOption], MakeValue(strArg));
+            m_nArgMoved++;
+            return;
+        }
+    }
+    m_bArgMoving = false;
+    m_fnArgument(strArg);
+}
+
+void CParseContext::SaveOption(char cShortName)
+{
+    // the name is a local char, not in argv, always copy it
+    bool bKeepToken = m_bKeepToken;
+    m_bKeepToken = true;
+    SaveOption(util::CStrView(&cShortName, 1), "1");
+    m_bKeepToken = bKeepToken;
+}
+
+void CParseContext::SaveOption(const util::CStrView& strLongName, const util::CStrView& strArg)
+{
+    if (m_stArgRecv.FindUnknown(strLongName) >= 0)
+    {
+        return;
+    }
+
+    CArgUnknown stUnknown;
+    stUnknown.m_stName = MakeValue(strLongName);
+    stUnknown.m_iValue = m_stArgRecv.m_vecValue.size();
+    m_stArgRecv.m_vecValue.push_back(MakeValue(strArg));
+
+    int iUnknown = m_stArgRecv.m_vecUnknown.size();
+    m_stArgRecv.m_vecUnknown.push_back(stUnknown);
+    m_stArgRecv.m_stUnknownIndex.Insert(strLongName.data(), strLongName.size(), iUnknown,
+            [this](int id) { return m_stArgRecv.View(m_stArgRecv.m_vecUnknown[id].m_stName); });
+}
+
+void CParseContext::SaveOption(const COption& stOption)
+{
+    assert(!stOption.m_bArgument);
+    int iOption = &stOption - &m_pSpec->m_vecOptions[0];
+    CArgSlot& stSlot = m_stArgRecv.m_vecOption[iOption];
+    if (stSlot.m_nCount == 0)
+    {
+        m_stArgRecv.Append(stSlot, CArgument::Refer("1"));
+    }
+}
+
+void CParseContext::SaveOption(const COption& stOption, const util::CStrView& strArg)
+{
+    SaveValue(stOption, MakeValue(strArg));
+}
+
+void CParseContext::SaveValue(const COption& stOption, const CArgValue& stValue)
+{
+    assert(stOption.m_bArgument);
+    int iOption = &stOption - &m_pSpec->m_vecOptions[0];
+    CArgSlot& stSlot = m_stArgRecv.m_vecOption[iOption];
+    if (stSlot.m_nCount == 0 || stOption.m_bRepeated)
+    {
+        m_stArgRecv.Append(stSlot, stValue);
+    }
+}
+
+bool CParseContext::CheckOptionArgument(const util::CStrView& strArg)
+{
+    if (m_stError.IsCatch(ERROR_CODE_ARGUMENT_INVALID) && IsInvalidArgument(strArg))
+    {
+        m_stError.SetError(ERROR_CODE_ARGUMENT_INVALID, strArg.ToString());
+        return false;
+    }
+    return true;
+}
+
+bool CParseContext::CheckRequiredOption()
+{
+    for (auto it = m_pSpec->m_vecRequired.begin(); it != m_pSpec->m_vecRequired.end(); ++it)
+    {
+        if (m_stArgRecv.GetOption(*it) == nullptr)
+        {
+            m_stError.SetError(ERROR_CODE_OPTION_REQUIRED, m_pSpec->m_vecOptions[*it].m_strLongName);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CParseContext::CheckUnknownOption()
+{
+    if (!m_stArgRecv.m_vecUnknown.empty())
+    {
+        util::CStrView strName = m_stArgRecv.View(m_stArgRecv.m_vecUnknown[0].m_stName);
+        m_stError.SetError(ERROR_CODE_OPTION_UNKNOWN, strName.ToString());
+        return false;
+    }
+    return true;
+}
+
+void CParseContext::MoveArgument()
+{
+    // move from #1 #2 ... in order
+    size_t nMoved = 0;
+    size_t nArgs = m_stArgRecv.m_vecArgs.size();
+    for (auto it = m_pSpec->m_vecBindPos.begin(); it != m_pSpec->m_vecBindPos.end() && nMoved < nArgs; ++it)
+    {
+        if (m_stArgRecv.GetOption(*it) != nullptr)
         {
             break;
         }
+        SaveValue(m_pSpec->m_vecOptions[*it], m_stArgRecv.m_vecArgs[nMoved]);
+        nMoved++;
     }
 
     if (nMoved > 0)
@@ -1114,24 +2681,197 @@ void CEnvBase::MoveArgument()
     }
 }
 
-void CEnvBase::ReadConfig(const std::string& strFile, std::vector<std::string>& cfgArgs)
+/// kind of config record, also saved in binary cache
+const char CONFIG_RECORD_NAMED = 'N';    //< key=val, key with group
+const char CONFIG_RECORD_ARGUMENT = 'A'; //< position argument after [--]
+const char CONFIG_RECORD_TOKEN = 'T';    //< line without '=', as cmdline
+
+/// magic header of config cache file, change it when format changed
+static const char CONFIG_CACHE_MAGIC[] = "CLIOPCF1";
+
+// file identity as string to compare, empty if cannot stat
+static std::string ConfigStamp(const std::string& strFile)
+{
+    struct stat stStat;
+    if (stat(strFile.c_str(), &stStat) != 0 || S_ISDIR(stStat.st_mode))
+    {
+        return std::string();
+    }
+    uint64_t aStamp[5] = {
+        static_cast<uint64_t>(stStat.st_size),
+        static_cast<uint64_t>(stStat.st_mtim.tv_sec),
+        static_cast<uint64_t>(stStat.st_mtim.tv_nsec),
+        static_cast<uint64_t>(stStat.st_ino),
+        static_cast<uint64_t>(stStat.st_dev),
+    };
+    std::string strStamp(reinterpret_cast<const char*>(aStamp), sizeof(aStamp));
+    strStamp.append(strFile);
+    return strStamp;
+}
+
+static void AppendField(std::string& strDest, const util::CStrView& strField)
+{
+    uint32_t uSize = strField.size();
+    strDest.append(reinterpret_cast<const char*>(&uSize), sizeof(uSize));
+    strDest.append(strField.data(), strField.size());
+}
+
+static bool ReadField(util::CStrView& strSrc, util::CStrView& strField)
+{
+    uint32_t uSize = 0;
+    if (strSrc.size() < sizeof(uSize))
+    {
+        return false;
+    }
+    memcpy(&uSize, strSrc.data(), sizeof(uSize));
+    if (strSrc.size() - sizeof(uSize) < uSize)
+    {
+        return false;
+    }
+    strField = strSrc.substr(sizeof(uSize), uSize);
+    strSrc = strSrc.substr(sizeof(uSize) + uSize);
+    return true;
+}
+
+void CParseContext::ReadConfig(const std::string& strFile)
 {
-    std::ifstream fin(strFile);
-	if (!fin)
-	{
-        if (m_stError.IsCatch(ERROR_CODE_CONFIG_UNREADABLE))
+    const std::string& strCache = m_pSpec->m_strConfigCache;
+    std::string strStamp;
+    if (!strCache.empty())
+    {
+        strStamp = ConfigStamp(strFile);
+        if (strStamp.empty())
+        {
+            if (m_stError.IsCatch(ERROR_CODE_CONFIG_UNREADABLE))
+            {
+                m_stError.SetError(ERROR_CODE_CONFIG_UNREADABLE, strFile);
+            }
+            return;
+        }
+    }
+
+    // the lines refer to the reader, copy only when saved
+    bool bKeepToken = m_bKeepToken;
+    m_bKeepToken = true;
+    m_vecTokens.clear();
+
+    if (strCache.empty() || !LoadConfigCache(strCache, strStamp))
+    {
+        util::CLineReader stReader;
+        if (!stReader.Open(strFile))
         {
-            m_stError.SetError(ERROR_CODE_CONFIG_UNREADABLE, strFile);
+            if (m_stError.IsCatch(ERROR_CODE_CONFIG_UNREADABLE))
+            {
+                m_stError.SetError(ERROR_CODE_CONFIG_UNREADABLE, strFile);
+            }
+        }
+        else if (strCache.empty())
+        {
+            ParseConfig(stReader, nullptr);
         }
-		return;
-	}
+        else
+        {
+            std::string strRecord(CONFIG_CACHE_MAGIC);
+            AppendField(strRecord, strStamp);
+            ParseConfig(stReader, &strRecord);
+
+            // write a temporary file and rename, not to break other reader
+            std::string strTemp = strCache;
+            strTemp.append(".").append(std::to_string(getpid()))
+                .append(".").append(std::to_string(reinterpret_cast<uintptr_t>(this)));
+            std::ofstream fout(strTemp, std::ios::binary);
+            if (!HasError() && fout.write(strRecord.data(), strRecord.size()))
+            {
+                fout.close();
+                rename(strTemp.c_str(), strCache.c_str());
+            }
+            else
+            {
+                fout.close();
+                remove(strTemp.c_str());
+            }
+        }
+    }
+
+    m_vecTokens.clear();
+    m_bKeepToken = bKeepToken;
+}
+
+bool CParseContext::LoadConfigCache(const std::string& strFile, const std::string& strStamp)
+{
+    util::CLineReader stReader;
+    if (!stReader.Open(strFile))
+    {
+        return false;
+    }
+    util::CStrView strContent = stReader.Content();
+    util::CStrView strMagic(CONFIG_CACHE_MAGIC);
+    util::CStrView strField;
+    if (strContent.substr(0, strMagic.size()) != strMagic)
+    {
+        return false;
+    }
+    strContent = strContent.substr(strMagic.size());
+    if (!ReadField(strContent, strField) || strField != strStamp)
+    {
+        return false;
+    }
+
+    // validate all records before apply any one
+    util::CStrView strRecord = strContent;
+    while (!strContent.empty())
+    {
+        char cKind = strContent[0];
+        strContent = strContent.substr(1);
+        if (!ReadField(strContent, strField) || !ReadField(strContent, strField))
+        {
+            return false;
+        }
+        if (cKind == CONFIG_RECORD_TOKEN && m_stError.IsCatch(ERROR_CODE_CONFIG_INVALID))
+        {
+            return false;
+        }
+    }
+
+    util::CStrView strKey;
+    util::CStrView strVal;
+    while (!strRecord.empty() && !HasError())
+    {
+        char cKind = strRecord[0];
+        strRecord = strRecord.substr(1);
+        ReadField(strRecord, strKey);
+        ReadField(strRecord, strVal);
+        ApplyConfig(cKind, strKey, strVal);
+    }
+    ApplyConfig(0, util::CStrView(), util::CStrView());
+    return true;
+}
+
+void CParseContext::ParseConfig(util::CLineReader& stReader, std::string* pRecord)
+{
+    auto fnApply = [this, pRecord](char cKind, const util::CStrView& strKey, const util::CStrView& strVal)
+    {
+        if (pRecord != nullptr)
+        {
+            pRecord->push_back(cKind);
+            AppendField(*pRecord, strKey);
+            AppendField(*pRecord, strVal);
+        }
+        ApplyConfig(cKind, strKey, strVal);
+    };
 
     bool bEndOption = false;
-    std::string strGroup;
-    std::string strLine;
-    while (std::getline(fin, strLine))
+    util::CStrView strGroup;
+    std::string strName;
+    std::string strBuffer;
+    util::CStrView strLine;
+    while (stReader.Next(strLine) && !HasError())
     {
-        util::Trim(strLine);
+        if (m_pStats)
+        {
+            m_pStats->m_nConfigLine++;
+        }
+        strLine = util::TrimView(strLine);
         if (strLine.empty() || strLine[0] == '#' || strLine[0] == ';')
         {
             continue;
@@ -1140,12 +2880,11 @@ void CEnvBase::ReadConfig(const std::string& strFile, std::vector<std::string>&
         if (strLine == "--" || strLine == "[--]")
         {
             bEndOption = true;
-            cfgArgs.push_back("--");
             continue;
         }
         if (bEndOption)
         {
-            cfgArgs.push_back(strLine);
+            fnApply(CONFIG_RECORD_ARGUMENT, util::Unquote(strLine, strBuffer), util::CStrView());
             continue;
         }
 
@@ -1156,55 +2895,218 @@ void CEnvBase::ReadConfig(const std::string& strFile, std::vector<std::string>&
         }
 
         size_t iEqual = strLine.find('=');
-        if (iEqual != std::string::npos)
-        {
-            std::string strKey = strLine.substr(0, iEqual);
-            std::string strVal = strLine.substr(iEqual + 1);
-            util::Trim(strKey);
-            util::Trim(strVal);
-            util::TrimLeft(strKey, '-');
-            if (!strGroup.empty())
+        if (iEqual == util::CStrView::npos)
+        {
+            if (m_stError.IsCatch(ERROR_CODE_CONFIG_INVALID))
             {
-                std::string strTemp = strGroup;
-                strTemp.append(1, '.').append(strKey);
-                strKey.swap(strTemp);
+                m_stError.SetError(ERROR_CODE_CONFIG_INVALID, strLine.ToString());
+                break;
             }
-            std::string strTemp = strKey;
-            strTemp.append(1, '=').append(strVal);
-            strLine.swap(strTemp);
+            // flag or option whose argument in next line, parse as cmdline
+            fnApply(CONFIG_RECORD_TOKEN, strLine, util::CStrView());
+            continue;
         }
-        else if (m_stError.IsCatch(ERROR_CODE_CONFIG_INVALID))
+
+        util::CStrView strKey = util::TrimView(strLine.substr(0, iEqual));
+        size_t iDash = 0;
+        while (iDash < strKey.size() && strKey[iDash] == '-')
         {
-            m_stError.SetError(ERROR_CODE_CONFIG_INVALID, strLine);
-            return;
+            iDash++;
+        }
+        strKey = strKey.substr(iDash);
+        if (strKey.empty())
+        {
+            fnApply(CONFIG_RECORD_ARGUMENT, strLine, util::CStrView());
+            continue;
+        }
+        if (!strGroup.empty())
+        {
+            strName.assign(strGroup.data(), strGroup.size()).append(1, '.').append(strKey.data(), strKey.size());
+            strKey = strName;
+        }
+        fnApply(CONFIG_RECORD_NAMED, strKey, util::Unquote(util::TrimView(strLine.substr(iEqual + 1)), strBuffer));
+    }
+
+    if (!HasError())
+    {
+        ApplyConfig(0, util::CStrView(), util::CStrView());
+    }
+}
+
+void CParseContext::ApplyConfig(char cKind, const util::CStrView& strKey, const util::CStrView& strVal)
+{
+    if (cKind == CONFIG_RECORD_TOKEN)
+    {
+        m_vecTokens.push_back(strKey);
+        return;
+    }
+    if (!m_vecTokens.empty())
+    {
+        ParseCmdline(m_vecTokens);
+        m_vecTokens.clear();
+    }
+    if (cKind == CONFIG_RECORD_ARGUMENT)
+    {
+        SaveArgument(strKey);
+    }
+    else if (cKind == CONFIG_RECORD_NAMED)
+    {
+        SaveNamed(strKey, strVal);
+    }
+}
+
+void CParseContext::SaveNamed(const util::CStrView& strName, const util::CStrView& strArg)
+{
+    const COption* pOption = m_pSpec->FindOption(strName);
+    if (m_pStats)
+    {
+        m_pStats->m_nLookup++;
+    }
+    if (pOption != nullptr)
+    {
+        SaveOption(*pOption, strArg);
+    }
+    else
+    {
+        SaveOption(strName, strArg);
+    }
+}
+
+CEnvBase& CEnvBase::Freeze()
+{
+    ReservedOption();
+    CEnvSpec& stSpec = Setup();
+    stSpec.m_setCatch = m_stError.CatchSet();
+    stSpec.m_iHelpOption = OptionId(OPTION_NAME_HELP);
+    stSpec.m_iVersionOption = OptionId(OPTION_NAME_VERSION);
+    stSpec.m_iConfigOption = OptionId(OPTION_NAME_CONFIG);
+    stSpec.m_iStatsOption = OptionId(OPTION_NAME_STATS);
+
+    bool bCatchBind = m_stError.IsCatch(ERROR_CODE_POSITION_BIND);
+    stSpec.m_vecRequired.clear();
+    stSpec.m_vecBindPos.clear();
+    stSpec.m_stEnvIndex.Clear();
+    for (size_t i = 0; i < stSpec.m_vecOptions.size(); ++i)
+    {
+        const COption& stOption = stSpec.m_vecOptions[i];
+        if (stOption.m_bRequired)
+        {
+            stSpec.m_vecRequired.push_back(i);
+        }
+        if (!stOption.m_strEnvName.empty())
+        {
+            stSpec.m_stEnvIndex.Insert(stOption.m_strEnvName.c_str(), stOption.m_strEnvName.size(), i,
+                    [&stSpec](int id) -> const std::string& { return stSpec.m_vecOptions[id].m_strEnvName; });
+        }
+
+        int iBindIndex = stOption.m_iBindIndex;
+        if (iBindIndex == 0)
+        {
+            continue;
+        }
+        if (iBindIndex < 0 || iBindIndex > (int)stSpec.m_vecOptions.size())
+        {
+            if (bCatchBind)
+            {
+                std::string strText = "beyond range of ";
+                strText.append(stOption.m_strLongName).append("#").append(std::to_string(iBindIndex));
+                m_stError.SetError(ERROR_CODE_POSITION_BIND, strText);
+                return *this;
+            }
+            continue;
+        }
+
+        if (iBindIndex > (int)stSpec.m_vecBindPos.size())
+        {
+            stSpec.m_vecBindPos.resize(iBindIndex, -1);
+        }
+        if (stSpec.m_vecBindPos[iBindIndex - 1] >= 0)
+        {
+            if (bCatchBind)
+            {
+                std::string strText = "redefined of ";
+                strText.append(stOption.m_strLongName).append("#").append(std::to_string(iBindIndex));
+                m_stError.SetError(ERROR_CODE_POSITION_BIND, strText);
+                return *this;
+            }
+            continue;
+        }
+        stSpec.m_vecBindPos[iBindIndex - 1] = i;
+    }
+
+    // only the continuous bound positions from #1 can be moved
+    for (size_t i = 0; i < stSpec.m_vecBindPos.size(); ++i)
+    {
+        if (stSpec.m_vecBindPos[i] < 0)
+        {
+            if (bCatchBind)
+            {
+                std::string strText = "no preposition bound index #";
+                strText += std::to_string(i + 1);
+                m_stError.SetError(ERROR_CODE_POSITION_BIND, strText);
+                return *this;
+            }
+            stSpec.m_vecBindPos.resize(i);
+            break;
         }
+    }
+
+    if (m_stArgRecv.m_vecOption.size() < stSpec.m_vecOptions.size())
+    {
+        m_stArgRecv.m_vecOption.resize(stSpec.m_vecOptions.size());
+    }
+    stSpec.m_bFrozen = true;
+    return *this;
+}
 
-        cfgArgs.push_back(strLine);
+std::shared_ptr<const CEnvSpec> CEnvBase::Share()
+{
+    // Catch() or Ignore() after Freeze() should also take effect
+    if (!m_pSpec->m_bFrozen || m_pSpec->m_setCatch != m_stError.CatchSet())
+    {
+        Freeze();
     }
+    return m_pSpec;
+}
+
+CEnvSpec& CEnvBase::Setup()
+{
+    // m_pSpec and m_pSetup refer to the same one, others are sharing it
+    if (m_pSetup.use_count() > 2)
+    {
+        m_pSetup = std::make_shared<CEnvSpec>(*m_pSetup);
+        m_pSpec = m_pSetup;
+    }
+    m_pSetup->m_bFrozen = false;
+    return *m_pSetup;
 }
 
 void CEnvBase::ReservedOption()
 {
-    COption* pConfig = FindOption(OPTION_NAME_CONFIG);
-    if (nullptr == pConfig)
+    int iConfig = OptionId(OPTION_NAME_CONFIG);
+    if (iConfig < 0)
     {
         std::string strConfig = program_invocation_short_name;
         strConfig += ".ini";
         Option('\0', OPTION_NAME_CONFIG, "read arguments from config file", strConfig);
     }
-    else if (pConfig->m_strDefault.empty())
+    else if (m_pSpec->m_vecOptions[iConfig].m_strDefault.empty())
     {
-        pConfig->m_strDefault = std::string(program_invocation_short_name) + ".ini";
+        Setup().m_vecOptions[iConfig].m_strDefault = std::string(program_invocation_short_name) + ".ini";
     }
 
-    if (nullptr == FindOption(OPTION_NAME_VERSION))
+    if (nullptr == m_pSpec->FindOption(OPTION_NAME_VERSION))
     {
         Flag('\0', OPTION_NAME_VERSION, "print version");
     }
-    if (nullptr == FindOption(OPTION_NAME_HELP))
+    if (nullptr == m_pSpec->FindOption(OPTION_NAME_HELP))
     {
         Flag('\0', OPTION_NAME_HELP, "print help message");
     }
+    if (m_pStats && nullptr == m_pSpec->FindOption(OPTION_NAME_STATS))
+    {
+        Flag('\0', OPTION_NAME_STATS, "print parse statistics to stderr");
+    }
 }
 
 void CEnvBase::Help()
@@ -1254,7 +3156,7 @@ void CEnvBase::Usage(std::string& outText)
 
     outText.append("Option:\n");
     util::CTextAlign align;
-    for (auto it = m_vecOptions.begin(); it != m_vecOptions.end(); ++it)
+    for (auto it = m_pSpec->m_vecOptions.begin(); it != m_pSpec->m_vecOptions.end(); ++it)
     {
         std::string strName("  ");
         if (it->m_cShortName != '\0')
@@ -9,9 +9,15 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <map>
 #include <set>
 #include <functional>
+#include <memory>
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include "util-string.h"
 
 namespace cli
 {
@@ -28,9 +34,12 @@ enum ErrorCode
     ERROR_CODE_CONFIG_INVALID,     //< config line may confuse or invalid
     ERROR_CODE_ARGUMENT_INVALID,   //< argument may confuse or invalid
     ERROR_CODE_ARGTYPE_UNMATCH,    //< argument bound type is unmatch
+    ERROR_CODE_ARGUMENT_OVERFLOW,  //< argument number out of bound type range
     ERROR_CODE_POSITION_BIND,      //< position argument bound index mistake
     ERROR_CODE_OPTION_REQUIRED,    //< required option absent
     ERROR_CODE_OPTION_UNKNOWN,     //< unexpected option encountered
+    ERROR_CODE_RESPONSE_DEPTH,     //< response file @file nested too deep
+    ERROR_CODE_PLUGIN_LOAD,        //< sub-command can not be created or loaded
 
     // specify catch before Option() or Set()
     ERROR_CODE_OPTION_INVALID,     //< option name may confuse or invalid
@@ -85,6 +94,9 @@ public:
     /** Ignore the specified error code in later process. */
     void IgnoreError(int code) { m_setCatch.erase(code); }
 
+    /** Get all error codes to catch. */
+    const std::set<int>& CatchSet() const { return m_setCatch; }
+
     /** Check wheter will catch the error specified code. */
     bool IsCatch(int code) { return m_setCatch.count(code) > 0; }
 
@@ -119,15 +131,245 @@ struct COption
     COption(char cShortName, const std::string& strLongName, const std::string strDescription);
 };
 
-/** The argument struct that actually read from cmdline. */
+/** Hash index from name to integer id, by open addressing.
+ * @note The name is not stored in index, but only its hash code, so the
+ * caller should provide a functor `getName(id)` to compare the real name,
+ * which return any string type that has `data()` and `size()` method.
+ * @note Insert only, no remove, the first inserted id take effect.
+ * */
+class CNameIndex
+{
+    struct CSlot
+    {
+        uint32_t m_uHash = 0;
+        int m_iId = -1;
+    };
+    std::vector<CSlot> m_vecSlot; //< size is power of 2 or empty
+    size_t m_nCount = 0;          //< used slots
+
+public:
+    /** Hash a byte string, FNV-1a. */
+    static uint32_t Hash(const char* pName, size_t nSize)
+    {
+        uint32_t uHash = 2166136261u;
+        for (size_t i = 0; i < nSize; ++i)
+        {
+            uHash ^= static_cast<unsigned char>(pName[i]);
+            uHash *= 16777619u;
+        }
+        return uHash;
+    }
+
+    /** Find id by name, return -1 if not found. */
+    template <typename fnName>
+    int Find(const char* pName, size_t nSize, fnName getName) const
+    {
+        if (m_vecSlot.empty())
+        {
+            return -1;
+        }
+        uint32_t uHash = Hash(pName, nSize);
+        size_t uMask = m_vecSlot.size() - 1;
+        for (size_t i = uHash & uMask; ; i = (i + 1) & uMask)
+        {
+            const CSlot& stSlot = m_vecSlot[i];
+            if (stSlot.m_iId < 0)
+            {
+                return -1;
+            }
+            if (stSlot.m_uHash == uHash)
+            {
+                const auto& strName = getName(stSlot.m_iId);
+                if (strName.size() == nSize && memcmp(strName.data(), pName, nSize) == 0)
+                {
+                    return stSlot.m_iId;
+                }
+            }
+        }
+    }
+
+    /** Insert name with id, return false if the name already exists. */
+    template <typename fnName>
+    bool Insert(const char* pName, size_t nSize, int iId, fnName getName)
+    {
+        if (Find(pName, nSize, getName) >= 0)
+        {
+            return false;
+        }
+        if ((m_nCount + 1) * 2 > m_vecSlot.size())
+        {
+            Rehash(m_vecSlot.empty() ? 16 : m_vecSlot.size() * 2);
+        }
+        Place(Hash(pName, nSize), iId);
+        m_nCount++;
+        return true;
+    }
+
+    /** Count of names in index. */
+    size_t Size() const { return m_nCount; }
+
+    /** Remove all names, but keep the capacity. */
+    void Clear();
+
+private:
+    void Place(uint32_t uHash, int iId);
+    void Rehash(size_t nSlot);
+};
+
+/** Option declared at compile time, see cliop-static.h.
+ * @note The strings are not copied, usually literal that live forever.
+ * */
+struct COptionDecl
+{
+    char m_cShortName;            //< short name: -n, '\0' for none
+    const char* m_pLongName;      //< long name: --LongName
+    const char* m_pDescription;   //< description text in help usage
+    const char* m_pDefault;       //< default argument value if not provided
+    int m_uAttr;                  //< bit or of OPTION_ARGUMENT etc.
+
+    constexpr COptionDecl(char cShortName, const char* pLongName, const char* pDescription,
+            const char* pDefault = "", int uAttr = OPTION_ARGUMENT)
+        : m_cShortName(cShortName), m_pLongName(pLongName), m_pDescription(pDescription),
+          m_pDefault(pDefault), m_uAttr(uAttr) {}
+};
+
+/** Perfect hash index of long names in an array of @ref COptionDecl.
+ * @details The seed and slot table are computed at compile time, so that
+ * each name maps to a distinct slot, lookup only hash once and compare once.
+ * */
+struct CPerfectIndex
+{
+    const COptionDecl* m_pDecl;   //< declared options
+    size_t m_nDecl;               //< count of declared options
+    uint32_t m_uSeed;             //< hash seed without collision
+    uint32_t m_uMask;             //< slot count - 1, power of 2
+    const int* m_pSlot;           //< index of m_pDecl in each slot, or -1
+
+    /** Hash the name, same as @ref CNameIndex::Hash() but in compile time. */
+    static constexpr uint32_t Hash(const char* pName, uint32_t uHash = 2166136261u)
+    {
+        return *pName == '\0' ? uHash
+            : Hash(pName + 1, (uHash ^ static_cast<unsigned char>(*pName)) * 16777619u);
+    }
+
+    /** Mix the name hash with seed to slot, by murmur3 finalizer. */
+    static constexpr uint32_t Slot(uint32_t uHash, uint32_t uSeed, uint32_t uMask)
+    {
+        return Mix3(Mix2(Mix1(uHash ^ (uSeed * 2654435761u)))) & uMask;
+    }
+    static constexpr uint32_t Mix1(uint32_t h) { return (h ^ (h >> 16)) * 0x85ebca6bu; }
+    static constexpr uint32_t Mix2(uint32_t h) { return (h ^ (h >> 13)) * 0xc2b2ae35u; }
+    static constexpr uint32_t Mix3(uint32_t h) { return h ^ (h >> 16); }
+
+    /** Find the index in m_pDecl by long name, return -1 if not found. */
+    int Find(const char* pName, size_t nSize) const
+    {
+        int iDecl = m_pSlot[Slot(CNameIndex::Hash(pName, nSize), m_uSeed, m_uMask)];
+        if (iDecl < 0)
+        {
+            return -1;
+        }
+        const char* pLongName = m_pDecl[iDecl].m_pLongName;
+        if (strncmp(pLongName, pName, nSize) != 0 || pLongName[nSize] != '\0')
+        {
+            return -1;
+        }
+        return iDecl;
+    }
+};
+
+/** Reference to a received value.
+ * It either refer to outside memory such as argv from main(), or the offset
+ * in the buffer of @ref CArgument that keeps a copy.
+ * */
+struct CArgValue
+{
+    const char* m_pExtern = nullptr; //< outside memory, null if in buffer
+    size_t m_iOffset = 0;            //< offset in buffer if not extern
+    size_t m_nSize = 0;              //< length of value
+    int m_iNext = -1;                //< next value of repeated option
+};
+
+/** Slot of received option, link to its values in CArgument. */
+struct CArgSlot
+{
+    int m_iFirst = -1;               //< index of first value, -1 if absent
+    int m_iLast = -1;                //< index of last value
+    int m_nCount = 0;                //< count of values
+};
+
+/** Received option that has not been setup. */
+struct CArgUnknown
+{
+    CArgValue m_stName;              //< option name as received
+    int m_iValue = -1;               //< index of value in CArgument::m_vecValue
+};
+
+/** The argument struct that actually read from cmdline.
+ * @details Received values are saved in a flat array, and the option saves
+ * only the index of its value in a slot array indexed by option id, which is
+ * the index of setup option in @ref CEnvBase. Received but unknown option is
+ * saved in another array by name. The values of repeated option are linked
+ * as a list in received order.
+ * @note The values from argv of main() only refer to it, which live for the
+ * whole process, other values such as from config file are copied to a
+ * contiguous buffer.
+ * @note All arrays and buffer keep their capacity when cleared, so that
+ * repeated Feed() may not allocate any more.
+ * */
 struct CArgument
 {
-    /// Option and their argument saved in map, with long name as key.
-    /// @note The value of flag that has no argument is unimportant.
-    std::map<std::string, std::string> m_mapArgs;
+    std::vector<CArgSlot> m_vecOption;     //< value slot of each option id
+    std::vector<CArgUnknown> m_vecUnknown; //< received option not setup
+    CNameIndex m_stUnknownIndex;           //< name index for m_vecUnknown
+    std::vector<CArgValue> m_vecValue;     //< all received option values
+    std::vector<CArgValue> m_vecArgs;      //< position arguments
+    std::string m_strBuffer;               //< copy of value not from argv
+
+    /** Clear all received, and reset slot for `nOption` option id. */
+    void Clear(size_t nOption);
+
+    /** Get the string view of a value.
+     * @note The view is valid only before next saving value in buffer.
+     * */
+    util::CStrView View(const CArgValue& stValue) const
+    {
+        if (stValue.m_pExtern != nullptr)
+        {
+            return util::CStrView(stValue.m_pExtern, stValue.m_nSize);
+        }
+        return util::CStrView(m_strBuffer.data() + stValue.m_iOffset, stValue.m_nSize);
+    }
+
+    /** Make a value refer to outside memory. */
+    static CArgValue Refer(const util::CStrView& strValue)
+    {
+        CArgValue stValue;
+        stValue.m_pExtern = strValue.data();
+        stValue.m_nSize = strValue.size();
+        return stValue;
+    }
+
+    /** Make a value by copy to buffer. */
+    CArgValue Keep(const util::CStrView& strValue);
 
-    /// other position argument saved in vector
-    std::vector<std::string> m_vecArgs;
+    /** Append a value to the slot, return the index of value. */
+    int Append(CArgSlot& stSlot, const CArgValue& stValue);
+
+    /** Find the index of unknown option by name, -1 if not found. */
+    int FindUnknown(const util::CStrView& strName) const;
+
+    /** Get the first value of an option id or an unknown name, null if absent.
+     * @note Follow `CArgValue::m_iNext` to get more values of repeated option.
+     * */
+    const CArgValue* GetOption(int iOption) const;
+    const CArgValue* GetUnknown(const util::CStrView& strName) const;
+
+    /** Get the next value of repeated option, null if no more. */
+    const CArgValue* Next(const CArgValue* pValue) const
+    {
+        return pValue->m_iNext < 0 ? nullptr : &m_vecValue[pValue->m_iNext];
+    }
 };
 
 /** The type of option argument value. */
@@ -137,31 +379,45 @@ enum EOptionType
     OPTION_STR = 1,     //< argument used as st::string
     OPTION_INT = 2,     //< argument used as int
     OPTION_DOUBLE = 3,  //< argument used as double
+    OPTION_INT64 = 4,   //< argument used as int64_t
+    OPTION_UINT64 = 5,  //< argument used as uint64_t
+    OPTION_FLOAT = 6,   //< argument used as float
 
     OPTION_STR_LIST = 11,    //< used as std::vector<std::string>
     OPTION_INT_LIST = 12,    //< used as std::vector<int>
     OPTION_DOUBLE_LIST = 13, //< used as std::vector<double>
 };
 
-/** Convert string to other type value. */
-void ConvertValue(const std::string& src, std::string &dest);
-void ConvertValue(const std::string& src, int &dest);
-void ConvertValue(const std::string& src, double &dest);
-void ConvertValue(const std::string& src, std::vector<std::string> &dest);
-void ConvertValue(const std::string& src, std::vector<int> &dest);
-void ConvertValue(const std::string& src, std::vector<double> &dest);
+/** Convert string to other type value.
+ * @return int: 0 for success, or util::NUMBER_INVALID, util::NUMBER_OVERFLOW
+ * @note Number is parsed by @ref util::ParseNumber(), and list from string
+ * joined by '\0', each item is converted.
+ * */
+int ConvertValue(const std::string& src, std::string &dest);
+int ConvertValue(const std::string& src, int &dest);
+int ConvertValue(const std::string& src, int64_t &dest);
+int ConvertValue(const std::string& src, uint64_t &dest);
+int ConvertValue(const std::string& src, double &dest);
+int ConvertValue(const std::string& src, float &dest);
+int ConvertValue(const std::string& src, std::vector<std::string> &dest);
+int ConvertValue(const std::string& src, std::vector<int> &dest);
+int ConvertValue(const std::string& src, std::vector<double> &dest);
 
 /** Information for option bind with variable. */
 struct COptionBind
 {
     EOptionType m_eValueType = OPTION_STR;
     void* m_pBindValue = nullptr;
+    char m_cDelimiter = '\0';    //< split each value of list by it if not 0
 
-    COptionBind(EOptionType eValueType = OPTION_STR, void* pBindValue = nullptr)
-        : m_eValueType(eValueType), m_pBindValue(pBindValue) {}
+    COptionBind(EOptionType eValueType = OPTION_STR, void* pBindValue = nullptr, char cDelimiter = '\0')
+        : m_eValueType(eValueType), m_pBindValue(pBindValue), m_cDelimiter(cDelimiter) {}
 };
 
 class CEnvBase;
+class CParseContext;
+class CArgSnapshot;
+class CBatchResult;
 
 /** Command handle function type.
  * @param [IN] argc: argument count as main()
@@ -171,6 +427,41 @@ class CEnvBase;
  * */
 typedef std::function<int (int argc, const char* argv[], CEnvBase* args)> FCommandHandler;
 
+/** Sub-command factory type, create the handle object when dispatched. */
+typedef std::function<std::unique_ptr<CEnvBase> ()> FCommandFactory;
+
+/** Entry function of sub-command plugin, return object created by `new`. */
+typedef CEnvBase* (*FPluginEntry)();
+
+/** Default entry symbol of sub-command plugin. */
+#define CLIOP_PLUGIN_ENTRY "cliop_plugin_command"
+
+/** Define the default entry in plugin shared object, as `new envT()`. */
+#define CLIOP_PLUGIN_COMMAND(envT) \
+    extern "C" cli::CEnvBase* cliop_plugin_command() { return new envT(); }
+
+/** Config changed callback type.
+ * @param [IN] vecChanged: long names of options changed after reload.
+ * */
+typedef std::function<void (const std::vector<std::string>& vecChanged)> FConfigChanged;
+
+/** Argument source function type, as generator of cmdline tokens.
+ * @param [OUT] strArg: the next argument, valid until next call.
+ * @return bool: false if no more argument.
+ * */
+typedef std::function<bool (util::CStrView& strArg)> FArgSource;
+
+/** Position argument callback type, in streaming mode.
+ * @param [IN] strArg: the position argument, valid only in the call.
+ * */
+typedef std::function<void (const util::CStrView& strArg)> FArgumentHandler;
+
+/** Make argument source that read whitespace separated tokens from fd.
+ * @param [IN] fd: opened file descriptor, such as 0 for stdin.
+ * @note The fd is read in chunks as @ref util::CTokenReader, and not closed.
+ * */
+FArgSource StreamSource(int fd);
+
 /** Command data collection */
 struct CommandInfo
 {
@@ -178,33 +469,184 @@ struct CommandInfo
     std::string m_strDescription; //< command help description text
     FCommandHandler m_fnHandler;  //< simple handle function without object
     CEnvBase* m_pEnvBase = nullptr;   //< command handle object
+    FCommandFactory m_fnFactory;      //< create m_pEnvBase when dispatched
+    std::shared_ptr<CEnvBase> m_pOwned; //< object created by m_fnFactory or plugin
+    std::string m_strPlugin;          //< shared object to create m_pEnvBase
+    std::string m_strEntry;           //< entry symbol in m_strPlugin
 
     CommandInfo() {}
     CommandInfo(const std::string& strName, const std::string& strDescription)
         : m_strName(strName), m_strDescription(strDescription) {}
 };
 
-/** Manage option and argument from cmdline, as environment to start up program. */
-class CEnvBase
+/** Option setup that can be shared by parse context in multiple threads.
+ * @details It is built by @ref CEnvBase, and after frozen, get the immutable
+ * shared object by @ref CEnvBase::Share() to create @ref CParseContext.
+ * */
+struct CEnvSpec
 {
     std::vector<COption> m_vecOptions; //< option setup
-    std::map<std::string, COptionBind> m_mapBind; //< option bind
+    CNameIndex m_stLongIndex;          //< long name to index of m_vecOptions
+    int m_aShortIndex[256] = {0};      //< short name to index+1 of m_vecOptions
+    const CPerfectIndex* m_pPerfect = nullptr; //< long name of declared options
+    std::set<int> m_setCatch;          //< error codes to catch in parsing
+    std::string m_strEnvPrefix;        //< import environment variables with it
+    std::string m_strConfigCache;      //< binary cache file of parsed config
+    int m_nResponseDepth = 0;          //< max nested depth of @file, 0 to disable
+
+    /// tables precomputed by CEnvBase::Freeze()
+    bool m_bFrozen = false;            //< option setup is frozen
+    int m_iHelpOption = -1;            //< option id of --help
+    int m_iVersionOption = -1;         //< option id of --version
+    int m_iConfigOption = -1;          //< option id of --config
+    int m_iStatsOption = -1;           //< option id of --cliop-stats, if stats enabled
+    std::vector<int> m_vecBindPos;     //< option id bound to position #1 #2 ...
+    std::vector<int> m_vecRequired;    //< option id that is required
+    CNameIndex m_stEnvIndex;           //< environment name to option id
+
+    /** Get the id of option, which is the index in setup, -1 if not found. */
+    int OptionId(const util::CStrView& strLongName) const
+    {
+        // declared options are always in the front of m_vecOptions
+        if (m_pPerfect != nullptr)
+        {
+            int iDecl = m_pPerfect->Find(strLongName.data(), strLongName.size());
+            if (iDecl >= 0)
+            {
+                return iDecl;
+            }
+        }
+        return m_stLongIndex.Find(strLongName.data(), strLongName.size(),
+                [this](int id) -> const std::string& { return m_vecOptions[id].m_strLongName; });
+    }
+
+    /** Get the id of option bound to environment variable, -1 if not found. */
+    int EnvOptionId(const util::CStrView& strEnvName) const
+    {
+        return m_stEnvIndex.Find(strEnvName.data(), strEnvName.size(),
+                [this](int id) -> const std::string& { return m_vecOptions[id].m_strEnvName; });
+    }
+
+    /** Get the id of option by short name, -1 if not found. */
+    int OptionId(char cShortName) const
+    {
+        return m_aShortIndex[static_cast<unsigned char>(cShortName)] - 1;
+    }
+
+    /** Find option setting by name. */
+    const COption* FindOption(char cShortName) const
+    {
+        int iOption = OptionId(cShortName);
+        return iOption < 0 ? nullptr : &m_vecOptions[iOption];
+    }
+    const COption* FindOption(const util::CStrView& strLongName) const
+    {
+        int iOption = OptionId(strLongName);
+        return iOption < 0 ? nullptr : &m_vecOptions[iOption];
+    }
+};
+
+/** Phases of one Feed(), timed in @ref CParseStats. */
+enum EParsePhase
+{
+    PARSE_PHASE_ENV,        //< snapshot environment variables
+    PARSE_PHASE_CMDLINE,    //< parse cmdline tokens
+    PARSE_PHASE_MOVE,       //< move position argument to bound option
+    PARSE_PHASE_CONFIG,     //< read config file and parse it
+    PARSE_PHASE_BIND,       //< assign bound variables
+    PARSE_PHASE_CHECK,      //< check required and unknown option
+    PARSE_PHASE_COUNT,
+};
+
+/** Statistics of Feed() in a parse context, summed until Clear().
+ * @note Only collected after @ref CParseContext::EnableStats(), otherwise
+ * each phase costs only a branch on null pointer.
+ * */
+struct CParseStats
+{
+    uint64_t m_aPhaseNs[PARSE_PHASE_COUNT] = {0}; //< monotonic time of each phase
+    uint64_t m_nFeed = 0;          //< times of Feed()
+    uint64_t m_nToken = 0;         //< tokens parsed, from cmdline and config
+    uint64_t m_nConfigLine = 0;    //< lines read from config file
+    uint64_t m_nCopyBytes = 0;     //< bytes of token copied to saved value
+    uint64_t m_nLookup = 0;        //< option name looked up in setup
+
+    void Clear() { *this = CParseStats(); }
+
+    /** Monotonic clock in nanoseconds. */
+    static uint64_t Now();
+
+    /** Add the time since `uBegin` to phase, return now as the next begin. */
+    uint64_t Mark(EParsePhase ePhase, uint64_t uBegin)
+    {
+        uint64_t uNow = Now();
+        m_aPhaseNs[ePhase] += uNow - uBegin;
+        return uNow;
+    }
+
+    /** Format as aligned `name: value` lines. */
+    void Format(std::string& outText) const;
+};
+
+/** Context to parse cmdline and save received argument.
+ * @details The context only refer to a frozen @ref CEnvSpec, and has its own
+ * received argument and error state, so that multiple contexts in different
+ * threads can parse concurrently with the same shared option setup.
+ * @note The context does not write bound variables, nor handle sub-command or
+ * print help, these are the work of @ref CEnvBase. Use Get() for the value.
+ * */
+class CParseContext
+{
+protected:
+    std::shared_ptr<const CEnvSpec> m_pSpec; //< option setup
     CArgument m_stArgRecv;             //< actually received option and argument
+    CErrorRun m_stError;               //< runtime error, only save the last one
+    std::vector<util::CStrView> m_vecTokens; //< cmdline tokens to parse
+    bool m_bKeepToken = false;         //< save copy of token not from argv
+
+    /// materialized copy of received argument, only for Args() and Argv()
+    std::map<std::string, std::string> m_mapArgsCopy;
+    std::vector<std::string> m_vecArgsCopy;
+    bool m_bArgsCopied = false;
+    bool m_bArgvCopied = false;
+
+    /** Converted value of an option for typed Get<valueT>(). */
+    struct CCachedValue
+    {
+        const void* m_pType = nullptr;  //< tag of value type
+        uint32_t m_nFeed = 0;           //< feed count when converted
+        std::unique_ptr<CCachedValue> m_pNext; //< other type of the same option
+        virtual ~CCachedValue() {}
+    };
+    template <typename valueT>
+    struct CCachedTyped : public CCachedValue
+    {
+        valueT m_value = valueT();
+    };
+    std::vector<std::unique_ptr<CCachedValue>> m_vecCache; //< by option id
+    std::map<std::string, std::unique_ptr<CCachedValue>> m_mapCache; //< by other name
+    uint32_t m_nFeed = 0;              //< count of Feed(), to expire the cache
 
-    std::string m_strVersion;          //< command version
-    CommandInfo m_stCommand;           //< command detail and handle
-    std::vector<CommandInfo> m_vecCommand; //< sub-commands
-    CommandInfo* m_pSubCommand = nullptr; //< current sub-command
+    /// environment snapshot taken in Feed(), instead of getenv() each time
+    std::vector<std::string> m_vecEnvValue;   //< by option id
+    std::map<std::string, std::string> m_mapEnvImport; //< by prefix but no option setup
+    bool m_bEnvLoaded = false;
+    std::vector<bool> m_vecCmdline;    //< option id received from cmdline
 
-    CErrorRun m_stError;     //< runtime error, only save the last one
+    /// streaming position argument to callback instead of saving
+    FArgumentHandler m_fnArgument;
+    size_t m_nArgMoved = 0;            //< leading argument moved to bound option
+    bool m_bArgMoving = false;         //< still moving leading argument
 
-public:
+    std::unique_ptr<CParseStats> m_pStats; //< null if statistics disabled
 
-    /** Dummy function to deal with argument.
-     * @note argc and argv is from main(), may useless as already parsed in this
-     * object.
+public:
+    /** Create context with a frozen shared option setup.
+     * @note The setup must be frozen, get it from CEnvBase::Share().
+     * @note The error codes to catch are copied from the setup.
      * */
-    virtual int Run(int argc, const char* argv[]) { return 0; }
+    explicit CParseContext(std::shared_ptr<const CEnvSpec> pSpec);
+    virtual ~CParseContext() {}
 
     /** read vector of string as cmdline.
      * @param [IN] vecArgs: cmdline argument stored in vector.
@@ -217,16 +659,36 @@ public:
      * */
     int Feed(const std::vector<std::string>& vecArgs);
 
-    /** read raw cmdline, typically from main().
-     * @param [IN] argc: argument count, including program name as arv[0]
-     * @param [IN] argv: C-Style string array for all argument
-     * @return int: error code 0 for success
-     * @note Real arguments is in range argv[1 ... argc-1], and argv[argc] is null.
-     * @note The first argv[0] is name of command or program.
+    /** read raw cmdline, only parse argv[1 ... argc-1], ignore argv[0].
+     * @note The argv should live as long as this context.
      * */
-    int Feed(int argc, char* argv[]);
     int Feed(int argc, const char* argv[]);
 
+    /** read cmdline from argument source, one by one in streaming.
+     * @param [IN] fnSource: generator of argument, such as @ref StreamSource().
+     * @note Used when arguments are too many to pass by argv, each argument
+     * is copied to the received buffer when parsed.
+     * */
+    int Feed(const FArgSource& fnSource);
+
+    /** Parse many cmdlines against the same option setup, one per line.
+     * @param [IN] fnLine: generator of lines, each is a cmdline without argv[0].
+     * @param [OUT] stResult: append the result of each line in columns.
+     * @return size_t: count of lines parsed.
+     * @details Each line is split by whitespace, with quote as config file,
+     * and parsed without copy except quoted token, then the received values
+     * are appended to `stResult`, with error code of the line if any.
+     * @note Environment is read once for all lines, but config file is not
+     * read, nor --help handled, and unknown option is not saved in result.
+     * */
+    size_t FeedBatch(const FArgSource& fnLine, CBatchResult& stResult);
+    size_t FeedBatch(const std::vector<std::string>& vecLines, CBatchResult& stResult);
+
+    /** Read only config file as received argument, not cmdline.
+     * @return int: error code 0 for success
+     * */
+    int FeedConfig(const std::string& strFile);
+
     /** Check where the option is read in. */
     bool Has(const std::string& strOptionName);
 
@@ -260,10 +722,359 @@ public:
     bool Get(const std::string& strOptionName, bool& bArg);
     bool Get(const std::string& strOptionName, std::string& strArg);
     bool Get(size_t pos, std::string& strArg);
+
+    /** Get all values of repeated option, or position arguments by "--".
+     * @param [IN] cDelimiter: also split each value by it, such as `1,2,3`.
+     * @note Each value is converted and appended to the vector, without join
+     * and re-split as the raw string of Get(). Item not a valid number is
+     * skipped for the number vector.
+     * */
+    bool Get(const std::string& strOptionName, std::vector<std::string>& vecArg, char cDelimiter = '\0');
+    bool Get(const std::string& strOptionName, std::vector<int>& vecArg, char cDelimiter = '\0');
+    bool Get(const std::string& strOptionName, std::vector<double>& vecArg, char cDelimiter = '\0');
+
+    /** Get the option argument converted to `valueT`.
+     * @return bool: false if absent or cannot convert, then `outArg` is not
+     * changed, and ERROR_CODE_ARGTYPE_UNMATCH or ERROR_CODE_ARGUMENT_OVERFLOW
+     * is set if caught.
+     * */
     template <typename keyT, typename valueT>
     bool Get(keyT key, valueT& outArg)
     {
         std::string strArg = Get(key);
+        if (strArg.empty())
+        {
+            return false;
+        }
+        valueT value(outArg);
+        int iRet = ConvertValue(strArg, value);
+        if (iRet == util::NUMBER_INVALID && m_stError.IsCatch(ERROR_CODE_ARGTYPE_UNMATCH))
+        {
+            m_stError.SetError(ERROR_CODE_ARGTYPE_UNMATCH, strArg);
+        }
+        else if (iRet == util::NUMBER_OVERFLOW && m_stError.IsCatch(ERROR_CODE_ARGUMENT_OVERFLOW))
+        {
+            m_stError.SetError(ERROR_CODE_ARGUMENT_OVERFLOW, strArg);
+        }
+        if (iRet != 0)
+        {
+            return false;
+        }
+        outArg = std::move(value);
+        return true;
+    }
+
+    /** Get the option argument converted to `valueT`, such as `Get<int>("n")`.
+     * @return const valueT&: zero or empty value if option absent or cannot
+     * convert, the error is set if caught as `Get(strOptionName, valueT&)`.
+     * @note The value is converted only once after each Feed() and cached
+     * in this context, the same as `Get(strOptionName, valueT&)` for the
+     * first time, including default and environment value. Then later call
+     * return the cached reference, without allocation or parsing.
+     * @note The reference is valid until next Feed() of this context.
+     * */
+    template <typename valueT>
+    const valueT& Get(const std::string& strOptionName)
+    {
+        CCachedTyped<valueT>* pCache = FindCache<valueT>(strOptionName);
+        if (pCache->m_nFeed != m_nFeed)
+        {
+            ResetValue(pCache->m_value);
+            Get(strOptionName, pCache->m_value);
+            pCache->m_nFeed = m_nFeed;
+        }
+        return pCache->m_value;
+    }
+
+    /** Get the all option arguments in map of string.
+     * @note The map is copied from received argument on first call after Feed.
+     * */
+    const std::map<std::string, std::string>& Args();
+
+    /** Get the all position arguments, as vector of string.
+     * @note The vector is copied from received argument on first call after Feed.
+     * */
+    const std::vector<std::string>& Argv();
+
+    /** Get the count of position arguments. */
+    int Argc() { return m_stArgRecv.m_vecArgs.size(); }
+
+    /** Get the id of option, which is the index in setup, -1 if not found. */
+    int OptionId(const util::CStrView& strOptionName);
+
+    /** Get the actually received argument struct, in flat arrays.*/
+    const CArgument& GetArgument() { return m_stArgRecv; }
+
+    /** Get the option setup. */
+    const CEnvSpec& Spec() const { return *m_pSpec; }
+
+    /** Clear received argument, may be called before another Feed(); */
+    void ClearArgument();
+
+    void ClearError();
+
+    /** Check if has any error. */
+    bool HasError() { return !m_stError; }
+
+    /** Pass position arguments to callback as parsed, instead of saving.
+     * @param [IN] fnHandler: null to save position arguments as normal.
+     * @details The leading arguments are still moved to the option bound
+     * to position `#1 #2 ...`, but when parsed, so an explicit option later
+     * in cmdline will not take the place. Other position arguments, even
+     * from config file, are not saved, then Argc() is 0.
+     * */
+    void StreamArgument(FArgumentHandler fnHandler) { m_fnArgument = fnHandler; }
+
+    /** Collect @ref CParseStats in later Feed(), or disable and drop it. */
+    void EnableStats(bool bEnable = true);
+
+    /** Get the statistics, null if not enabled. */
+    CParseStats* Stats() { return m_pStats.get(); }
+
+    /** Copy the result of last Feed() to an immutable snapshot.
+     * @note Call it only after Feed() success, the snapshot can then be
+     * published by @ref CSnapshotPublisher to reader threads.
+     * */
+    std::shared_ptr<CArgSnapshot> MakeSnapshot();
+
+protected:
+    CParseContext() {}
+
+    /** Parse the tokens in `m_vecTokens` and do following check.
+     * @param [IN] fnSource: parse tokens from it instead if not null.
+     * @note Called by public Feed() after ClearArgument().
+     * */
+    int FeedTokens(const FArgSource& fnSource = nullptr);
+
+    /** Hook when --help or --version received.
+     * @return bool: true to stop Feed() with ERROR_CODE_HELP.
+     * */
+    virtual bool OnHelp(bool bVersion) { (void)bVersion; return true; }
+
+    /** Hook after all arguments received, before check required option. */
+    virtual void OnReceived() {}
+
+    /** Parse cmdline .
+     * @param [IN] vecArgs: cmdline argument stored in vector.
+     * @param [IN] pos: parse argument from pos, default parese all.
+     * @return int: error code 0 for success.
+     * @note When without any option setting,
+     * any short name consider as flag with no argument, and long name
+     * has argument. After read cmdline, flag can also Get() by short name,
+     * since donnot known it's corresponding long name.
+     * @note @ref Feed() whill call this.
+     * @note The memory referred by `vecArgs` must live as long as this, or
+     * set `m_bKeepToken` to save a copy of received value.
+     * */
+    int ParseCmdline(const std::vector<util::CStrView>& vecArgs, size_t pos = 0);
+
+    /** State of parsing cmdline that cross tokens. */
+    struct CParseState
+    {
+        bool m_bEndOption = false;             //< after `--`, all are argument
+        const COption* m_pLastOption = nullptr; //< expect argument for it
+        util::CStrView m_strLastOption;        //< unknown option maybe has argument
+        std::string m_strLastKeep;             //< copy of m_strLastOption if keep token
+        int m_nDepth = 0;                      //< nested depth of @file
+    };
+
+    /** Parse cmdline one by one from argument source, as ParseCmdline(). */
+    int ParseStream(const FArgSource& fnSource);
+
+    /** Parse one token of cmdline, return error code. */
+    int ParseToken(const util::CStrView& strArg, CParseState& stState);
+
+    /** Check the state after all tokens parsed, return error code. */
+    int FinishParse(const CParseState& stState);
+
+    /** Expand response file `@file` in cmdline, parse each token in it.
+     * @return int: error code 0 for success.
+     * @note If cannot read the file, save `@file` as normal argument. If
+     * nested too deep, report ERROR_CODE_RESPONSE_DEPTH if caught, or else
+     * also save it as normal argument.
+     * */
+    int ParseResponse(const util::CStrView& strArg, CParseState& stState);
+
+    /** Save received position argument. */
+    void SaveArgument(const util::CStrView& strArg);
+
+    /** Save received option argument or flag without argument.
+     * Non-repeated option can only be save once, the first once take effect.
+     * */
+    void SaveOption(char cShortName);
+    void SaveOption(const util::CStrView& strLongName, const util::CStrView& strArg);
+    void SaveOption(const COption& stOption);
+    void SaveOption(const COption& stOption, const util::CStrView& strArg);
+    void SaveValue(const COption& stOption, const CArgValue& stValue);
+
+    /** Get the head of cached values for option name, create if not exists. */
+    std::unique_ptr<CCachedValue>& CacheSlot(const std::string& strOptionName);
+
+    /** Find cached value of the type for option name, create if not exists. */
+    template <typename valueT>
+    CCachedTyped<valueT>* FindCache(const std::string& strOptionName)
+    {
+        static const char s_cTypeTag = 0;
+        std::unique_ptr<CCachedValue>& pHead = CacheSlot(strOptionName);
+        for (CCachedValue* pCache = pHead.get(); pCache != nullptr; pCache = pCache->m_pNext.get())
+        {
+            if (pCache->m_pType == &s_cTypeTag)
+            {
+                return static_cast<CCachedTyped<valueT>*>(pCache);
+            }
+        }
+        CCachedTyped<valueT>* pCache = new CCachedTyped<valueT>;
+        pCache->m_pType = &s_cTypeTag;
+        pCache->m_nFeed = m_nFeed - 1;
+        pCache->m_pNext = std::move(pHead);
+        pHead.reset(pCache);
+        return pCache;
+    }
+
+    /** Reset cached value before convert again, keep capacity of list. */
+    template <typename valueT>
+    static void ResetValue(valueT& value) { value = valueT(); }
+    template <typename valueT>
+    static void ResetValue(std::vector<valueT>& value) { value.clear(); }
+
+    /** Make value from token in parsing, copy to buffer if `m_bKeepToken`. */
+    CArgValue MakeValue(const util::CStrView& strArg);
+
+    /** Find the first received value of option, by long name or short name. */
+    const CArgValue* FindValue(const util::CStrView& strOptionName);
+
+    /** Call `fn(view)` for each value of option, or position argument by "--".
+     * Use default value if not received, return false if no value at all.
+     * */
+    template <typename fnValue>
+    bool EachValue(const util::CStrView& strOptionName, fnValue fn);
+
+    /** Read environment variables in one pass, for the options bound to
+     * environment name, or by the name with prefix as `APP_LOG_LEVEL` for
+     * option `log.level`. Called by Feed() before parse cmdline.
+     * */
+    void LoadEnvironment();
+
+    /** Get the environment value of option, empty if not set.
+     * @note Use the snapshot if loaded, otherwise call getenv().
+     * */
+    util::CStrView EnvValue(int iOption);
+
+    /** Get the value view of option, received or default or from environment.
+     * @note The view is valid only before next saving any value.
+     * */
+    util::CStrView Lookup(const util::CStrView& strOptionName);
+
+    /** Check if the argument for option in valid. */
+    bool CheckOptionArgument(const util::CStrView& strArg);
+
+    /** Check if all required options are provided. */
+    bool CheckRequiredOption();
+
+    /** Check if all option have been setup. */
+    bool CheckUnknownOption();
+
+    /** Move some postion argument to option argument as setup.
+     * The option bound to position is resolved in Freeze() already.
+     * Only move the first several continuous argument(s) to option if they
+     * are not provided explicitly. Only move real cmdline argument, but not
+     * thar read from config file, as you should edit config file clearly.
+     * */
+    void MoveArgument();
+
+    /** Read option/argument lines from config file and save them.
+     * @param [IN] strFile: config file path
+     * @details
+     * Normal cmdline arguments are separated by space, while
+     * arguments in config file are separate by line. The config file is
+     * compatible with ini file, where each `key=val` is just treated as
+     * `--key=val` in cmdline. The section `[group]` is prefix of each key
+     * under this group, as `--group.key=val`, but section is not necessary.
+     * Config file can has commet lines begin with `#` or `;`, and space are
+     * allowed around `=` or begin or end of line. The lines without `=` are
+     * considered as normal argument except section line.
+     * Special `--` or `[--]` is used to marked the following lines are all
+     * normal argument except comment line.
+     * The value or normal argument can be quoted by `"` or `'`, to keep the
+     * space in the ends, and escape char such as `\n` in double quote.
+     * @note The file is memory mapped and read in one pass, each line is
+     * saved as key/value view, only copy to received argument buffer.
+     * @note If cannot read config file, just silent ignore.
+     * @note Also skip read any config if specify --config=NONE
+     * */
+    void ReadConfig(const std::string& strFile);
+
+    /** Parse lines of config file, and apply each record.
+     * @param [OUT] pRecord: also append records in binary if not null.
+     * */
+    void ParseConfig(util::CLineReader& stReader, std::string* pRecord);
+
+    /** Apply a record from config file.
+     * @param [IN] cKind: CONFIG_RECORD_* constant in cpp file.
+     * @note Lines parsed as cmdline are collected, and parsed together
+     * before any other kind of record, or call with `cKind` 0 to finish.
+     * */
+    void ApplyConfig(char cKind, const util::CStrView& strKey, const util::CStrView& strVal);
+
+    /** Apply the records from binary cache if it is valid for config file.
+     * @return bool: false if cache is absent or out of date.
+     * */
+    bool LoadConfigCache(const std::string& strFile, const std::string& strStamp);
+
+    /** Save option as `--name=argument`, the same as in ParseCmdline(). */
+    void SaveNamed(const util::CStrView& strName, const util::CStrView& strArg);
+
+    /** Parse one line of FeedBatch(), and check as FeedTokens() does. */
+    void ParseBatchLine(const util::CStrView& strLine, std::string& strQuoted);
+
+    /** Append received argument of the line to columns of batch result. */
+    void SaveBatchLine(CBatchResult& stResult);
+
+};
+
+/** Immutable copy of a completed parse result, to share among threads.
+ * @details Each option value is resolved from received argument, environment
+ * or default when made, so reading it only look up the name, and never
+ * change anything. The snapshot also keep the option setup alive.
+ * */
+class CArgSnapshot
+{
+    friend class CParseContext;
+    friend class CSnapshotPublisher;
+
+    /** Resolved value of one option. */
+    struct CSnapValue
+    {
+        std::string m_strValue;        //< as CParseContext::Get(), repeated joined by '\0'
+        bool m_bHas = false;           //< as CParseContext::Has()
+    };
+
+    std::shared_ptr<const CEnvSpec> m_pSpec;  //< option setup
+    std::vector<CSnapValue> m_vecValue;       //< by option id
+    std::map<std::string, CSnapValue> m_mapOther; //< unknown option or imported environment
+    std::vector<std::string> m_vecArgs;       //< position arguments
+    std::string m_strArgsJoin;                //< position arguments joined by '\0'
+    uint64_t m_uVersion = 0;                  //< sequence number when published
+
+public:
+    /** Check where the option is read in. */
+    bool Has(const std::string& strOptionName) const;
+
+    /** Get the option argument as raw string, the same as @ref CParseContext::Get().
+     * @return const std::string&: refer to the snapshot, empty if absent.
+     * */
+    const std::string& Get(const std::string& strOptionName) const;
+
+    /** Get postion argument by index, based from 1, empty if exceed range. */
+    const std::string& Get(size_t pos) const;
+
+    /** Get the option argument converted to expected type.
+     * @return bool: true if option read or has default value.
+     * */
+    template <typename keyT, typename valueT>
+    bool Get(keyT key, valueT& outArg) const
+    {
+        const std::string& strArg = Get(key);
         if (!strArg.empty())
         {
             ConvertValue(strArg, outArg);
@@ -272,21 +1083,242 @@ public:
         return false;
     }
 
-    /** Get the all option arguments in map of string. */
-    const std::map<std::string, std::string>& Args() { return m_stArgRecv.m_mapArgs; }
+    /** Get the all position arguments. */
+    const std::vector<std::string>& Argv() const { return m_vecArgs; }
+    int Argc() const { return m_vecArgs.size(); }
 
-    /** Get the all position arguments, as vector of string. */
-    const std::vector<std::string>& Argv() { return m_stArgRecv.m_vecArgs; }
+    /** Get the sequence number, increased by each publish, 0 if not published. */
+    uint64_t Version() const { return m_uVersion; }
 
-    /** Get the count of position arguments. */
-    int Argc() { return Argv().size(); }
+    /** Get the option setup. */
+    const CEnvSpec& Spec() const { return *m_pSpec; }
+
+private:
+    const CSnapValue* FindValue(const std::string& strOptionName) const;
+};
+
+/** Publish snapshot of parse result to reader threads, RCU-style.
+ * @details The writer publishes a new snapshot after each successful parse,
+ * and readers hold reference to what they loaded, so the old snapshot is
+ * released by the last reader. Failed parse is never published.
+ * @note Reader thread should use @ref CSnapshotReader in hot path, which
+ * only check an atomic version, but not Load() each time, as the atomic
+ * operations on `std::shared_ptr` may use internal lock in std library.
+ * */
+class CSnapshotPublisher
+{
+    std::shared_ptr<const CArgSnapshot> m_pCurrent; //< access only by atomic_load/atomic_store
+    std::atomic<uint64_t> m_uVersion;               //< version of m_pCurrent
+
+public:
+    CSnapshotPublisher() : m_uVersion(0) {}
+    CSnapshotPublisher(const CSnapshotPublisher&) = delete;
+    CSnapshotPublisher& operator=(const CSnapshotPublisher&) = delete;
+
+    /** Publish a new snapshot, and stamp its version.
+     * @note The snapshot should not be modified after publish.
+     * */
+    void Publish(std::shared_ptr<CArgSnapshot> pSnapshot);
+
+    /** Get the current snapshot, null if not published yet. */
+    std::shared_ptr<const CArgSnapshot> Load() const
+    {
+        return std::atomic_load(&m_pCurrent);
+    }
+
+    /** Get the version of current snapshot, without lock. */
+    uint64_t Version() const { return m_uVersion.load(std::memory_order_acquire); }
+};
+
+/** Reader handle of published snapshot, one object per thread.
+ * @details It keeps a reference to the loaded snapshot, and only load again
+ * when the publisher's version changed, so each read is an atomic load of
+ * the version and compare.
+ * */
+class CSnapshotReader
+{
+    const CSnapshotPublisher& m_stPublisher;
+    std::shared_ptr<const CArgSnapshot> m_pSnapshot;
+    uint64_t m_uVersion = 0;
+
+public:
+    explicit CSnapshotReader(const CSnapshotPublisher& stPublisher)
+        : m_stPublisher(stPublisher) {}
+
+    /** Get the current snapshot, null if not published yet.
+     * @note The reference is valid until next call of this reader, so take
+     * it once and read all options of one request from it.
+     * */
+    const CArgSnapshot* Current()
+    {
+        uint64_t uVersion = m_stPublisher.Version();
+        if (uVersion != m_uVersion)
+        {
+            m_pSnapshot = m_stPublisher.Load();
+            m_uVersion = uVersion;
+        }
+        return m_pSnapshot.get();
+    }
+};
+
+/** Parse result of many cmdlines in columns, filled by @ref CParseContext::FeedBatch().
+ * @details Each option has a column of value span, one for each line, the
+ * values are in one buffer, repeated values are joined by '\0'. Position
+ * arguments of all lines are in one array, indexed by the offset table.
+ * */
+class CBatchResult
+{
+    friend class CParseContext;
+
+    /// mark of absent value in column
+    static const size_t SPAN_ABSENT = static_cast<size_t>(-1);
+
+    /** Value in m_strBuffer, which may exceed 4GiB for large batch. */
+    struct CSpan
+    {
+        size_t m_iOffset = SPAN_ABSENT;
+        size_t m_nSize = 0;
+    };
+
+    std::shared_ptr<const CEnvSpec> m_pSpec;      //< option setup
+    std::string m_strBuffer;                      //< all received values
+    std::vector<std::vector<CSpan>> m_vecColumn;  //< by option id, one per line
+    std::vector<std::string> m_vecFallback;       //< environment or default, by option id
+    std::vector<CSpan> m_vecArgs;                 //< position arguments of all lines
+    std::vector<size_t> m_vecArgIndex = {0};      //< begin in m_vecArgs of each line, and the end
+    std::vector<int> m_vecError;                  //< error code of each line
+
+public:
+    /** Get the count of lines. */
+    size_t Lines() const { return m_vecError.size(); }
+
+    /** Get the error code of line, 0 for success, -1 if exceed lines. */
+    int Error(size_t iLine) const { return iLine < Lines() ? m_vecError[iLine] : -1; }
+
+    /** Get the id of option, to get value without name lookup. */
+    int OptionId(const std::string& strOptionName) const;
+
+    /** Check if the option is read in the line, false if exceed lines. */
+    bool Has(size_t iLine, int iOption) const;
+    bool Has(size_t iLine, const std::string& strOptionName) const { return Has(iLine, OptionId(strOptionName)); }
+
+    /** Get the option argument of line, or environment or default value.
+     * @return util::CStrView: empty if unknown option or exceed lines.
+     * @note The view is valid until next FeedBatch() to this result.
+     * */
+    util::CStrView Get(size_t iLine, int iOption) const;
+    util::CStrView Get(size_t iLine, const std::string& strOptionName) const { return Get(iLine, OptionId(strOptionName)); }
+
+    /** Get the option argument of line converted to expected type.
+     * @return bool: false if absent or cannot convert, `outArg` not changed.
+     * */
+    template <typename keyT, typename valueT>
+    bool Get(size_t iLine, keyT key, valueT& outArg) const
+    {
+        util::CStrView strArg = Get(iLine, key);
+        if (strArg.empty())
+        {
+            return false;
+        }
+        valueT value(outArg);
+        if (ConvertValue(strArg.ToString(), value) != 0)
+        {
+            return false;
+        }
+        outArg = std::move(value);
+        return true;
+    }
+
+    /** Get the count of position arguments of line, 0 if exceed lines. */
+    int Argc(size_t iLine) const { return iLine < Lines() ? m_vecArgIndex[iLine + 1] - m_vecArgIndex[iLine] : 0; }
+
+    /** Get position argument of line by index, based from 1, empty if exceed range. */
+    util::CStrView Arg(size_t iLine, size_t pos) const;
+
+    /** Clear all lines, keep the capacity. */
+    void Clear();
+
+private:
+    util::CStrView View(const CSpan& stSpan) const
+    {
+        return util::CStrView(m_strBuffer.data() + stSpan.m_iOffset, stSpan.m_nSize);
+    }
+};
+
+/** Manage option and argument from cmdline, as environment to start up program. */
+class CEnvBase : public CParseContext
+{
+    std::shared_ptr<CEnvSpec> m_pSetup;           //< same as m_pSpec but mutable
+    std::map<std::string, COptionBind> m_mapBind; //< option bind
+
+    std::string m_strVersion;          //< command version
+    CommandInfo m_stCommand;           //< command detail and handle
+    std::vector<CommandInfo> m_vecCommand; //< sub-commands
+    CNameIndex m_stCommandIndex;       //< sub-command name to index of m_vecCommand
+    CommandInfo* m_pSubCommand = nullptr; //< current sub-command
+
+    int m_fdWatch = -1;                //< inotify fd to watch config file
+    std::string m_strWatchName;        //< base name of watched config file
+    int m_nSighupSeen = 0;             //< SIGHUP count already handled
+    FConfigChanged m_fnConfigChanged;  //< callback after reload config
+
+    CSnapshotPublisher m_stPublisher;  //< publish parse result to reader threads
+    bool m_bPublish = false;           //< publish after each Feed() and ReloadConfig()
+
+public:
+    CEnvBase();
+    virtual ~CEnvBase();
+
+    /** Dummy function to deal with argument.
+     * @note argc and argv is from main(), may useless as already parsed in this
+     * object.
+     * */
+    virtual int Run(int argc, const char* argv[]) { (void)argc; (void)argv; return 0; }
+
+    /** read vector of string as cmdline.
+     * @note See @ref CParseContext::Feed(), and will freeze option setup and
+     * resolve bound variables.
+     * */
+    int Feed(const std::vector<std::string>& vecArgs);
+
+    /** read raw cmdline, typically from main().
+     * @param [IN] argc: argument count, including program name as arv[0]
+     * @param [IN] argv: C-Style string array for all argument
+     * @return int: error code 0 for success
+     * @note Real arguments is in range argv[1 ... argc-1], and argv[argc] is null.
+     * @note The first argv[0] is name of command or program.
+     * */
+    int Feed(int argc, char* argv[]);
+    int Feed(int argc, const char* argv[]);
+
+    /** read cmdline from argument source, see @ref CParseContext::Feed(). */
+    int Feed(const FArgSource& fnSource);
+
+    /** Parse many cmdlines, see @ref CParseContext::FeedBatch(), and will
+     * freeze option setup, but not resolve bound variables.
+     * */
+    size_t FeedBatch(const FArgSource& fnLine, CBatchResult& stResult);
+    size_t FeedBatch(const std::vector<std::string>& vecLines, CBatchResult& stResult);
+
+    /** Finish option setup, validate and precompute tables for parsing.
+     * @return *this
+     * @details Add the reserved options, resolve the option bound to position
+     * argument and the required options, so that Feed() only do work for
+     * each argument. Error of position bound index is checked here.
+     * @note Feed() will call it implicitly if not frozen yet, and any setup
+     * later will unfreeze.
+     * */
+    CEnvBase& Freeze();
+
+    /** Freeze and get the option setup to create @ref CParseContext.
+     * @note The returned setup is immutable, any later setup on this object
+     * will copy a new one and leave the shared one unchanged.
+     * */
+    std::shared_ptr<const CEnvSpec> Share();
 
     /** Get the command name, similar as argv[0] but may not same. */
     const std::string& Arg0() { return m_stCommand.m_strName; }
 
-    /** Get the actually received argument struct, with a map and vector.*/
-    const CArgument& GetArgument() { return m_stArgRecv; }
-
     /** Set and get version string. */
     CEnvBase& Version(const std::string& strVersion);
     std::string Version() const;
@@ -315,6 +1347,36 @@ public:
     CEnvBase& SubCommand(const std::string& strName, const std::string& strDescription, FCommandHandler fnHandler);
     CEnvBase& SubCommand(const std::string& strName, const std::string& strDescription, CEnvBase& stEnvBase);
 
+    /** Set sub command created on demand.
+     * @param [IN] fnFactory: create the command handler object
+     * @return this
+     * @details Only name and description are saved, the handler object and
+     * its options are created when the sub-command is dispatched, including
+     * `sub --help`, then owned by this and reused in later Feed().
+     * @note If the factory return null, Feed() fails with
+     * ERROR_CODE_PLUGIN_LOAD, which is only reported if caught.
+     * */
+    CEnvBase& SubCommand(const std::string& strName, const std::string& strDescription, FCommandFactory fnFactory);
+
+    /** Set sub command created on demand as `new envT()`. */
+    template <typename envT>
+    CEnvBase& SubCommand(const std::string& strName, const std::string& strDescription)
+    {
+        return SubCommand(strName, strDescription, FCommandFactory([]() { return std::unique_ptr<CEnvBase>(new envT()); }));
+    }
+
+    /** Set sub command loaded from shared object on demand.
+     * @param [IN] strPlugin: path of shared object, as `dlopen()`
+     * @param [IN] strEntry: @ref FPluginEntry symbol to create handler object
+     * @return this
+     * @details The shared object is only loaded when the sub-command is
+     * dispatched, including `sub --help`, and not unloaded then.
+     * @note If cannot load or the entry return null, Feed() fails with
+     * ERROR_CODE_PLUGIN_LOAD, which is only reported if caught.
+     * */
+    CEnvBase& PluginCommand(const std::string& strName, const std::string& strDescription,
+            const std::string& strPlugin, const std::string& strEntry = CLIOP_PLUGIN_ENTRY);
+
     /** Add a pre-build sub-command, return self. */
     CEnvBase& AddCommand(const CommandInfo& stCommand);
 
@@ -327,6 +1389,59 @@ public:
     /** Add a pre-build option, return self. */
     CEnvBase& AddOption(const COption& stOption);
 
+    /** Import environment variables with the prefix as option default.
+     * @param [IN] strPrefix: such as "APP_", then `APP_LOG_LEVEL` is used
+     * for option `log.level` or else `log_level` if not provided in cmdline.
+     * @return *this
+     * @note Variable that has no option setup can still Get() by the name.
+     * Option bound to `$ENV` name explicitly has priority to prefix.
+     * */
+    CEnvBase& EnvPrefix(const std::string& strPrefix);
+
+    /** Cache parsed config file records in a binary file.
+     * @param [IN] strCacheFile: path of the cache file, empty to disable.
+     * @return *this
+     * @details The cache is keyed on config path, size, mtime and inode, so
+     * only one `stat()` is needed to validate it when Feed(). If the config
+     * file is changed, it is parsed and the cache is rewritten.
+     * @note Absent config file is found by the `stat()`, without open.
+     * */
+    CEnvBase& ConfigCache(const std::string& strCacheFile);
+
+    /** Expand response file `@file` in cmdline, as its content is inserted.
+     * @param [IN] nMaxDepth: max nested depth of response file, 0 to disable.
+     * @return *this
+     * @details The file is whitespace separated arguments, each can be quoted
+     * as in config file. It is read in chunks and parsed one by one, so can
+     * pass more arguments than the limit of argv.
+     * @note Argument after `--` or expected by the last option is not expanded.
+     * */
+    CEnvBase& ResponseFile(int nMaxDepth = 8);
+
+    /** Pass position arguments to callback, see @ref CParseContext::StreamArgument().
+     * @return *this
+     * @note Use with @ref ResponseFile() or Feed(FArgSource) for huge number
+     * of arguments, so the memory use stays constant.
+     * */
+    CEnvBase& StreamArgument(FArgumentHandler fnHandler);
+
+    /** Collect parse statistics, see @ref CParseContext::EnableStats().
+     * @return *this
+     * @note Also add reserved flag `--cliop-stats`, when received in cmdline
+     * the statistics are printed to stderr after Feed().
+     * */
+    CEnvBase& EnableStats(bool bEnable = true);
+
+    /** Add options declared at compile time, return self.
+     * @param [IN] stIndex: usually get from @ref StaticSpec() in cliop-static.h
+     * @note The declared options are checked at compile time. If declare
+     * before any other option setup, the long names are looked up by its
+     * perfect hash in OptionId(), and the runtime name index is not built,
+     * but each declaration is still copied to a @ref COption. Otherwise just
+     * add each one as @ref AddOption().
+     * */
+    CEnvBase& Declare(const CPerfectIndex& stIndex);
+
     /** Add a simple flag to option-setting.
      * @param [IN] cShortName: short name as -s
      * @param [IN] strLongName: long name as --LongName
@@ -381,7 +1496,7 @@ public:
     CEnvBase& Set(const std::string& strName, const std::string& strDescription, valueT& refVal)
     {
         Set(strName, strDescription);
-        COption& stOption = m_vecOptions.back();
+        const COption& stOption = m_pSpec->m_vecOptions.back();
         return Bind(stOption.m_strLongName, refVal);
     }
 
@@ -389,6 +1504,7 @@ public:
      * @param [IN] strOptionName: the long name of option.
      * @param [IN] refVal: bind option argument received to the variable
      * @return *this self object.
+     * @param [IN] cDelimiter: split each value to the bound list by it.
      * @note The lifetime of bind variable should long enouth compare to this.
      * @note Should call before parse cmdline.
      * */
@@ -396,17 +1512,12 @@ public:
     CEnvBase& Bind(const std::string& strOptionName, std::string& refVal);
     CEnvBase& Bind(const std::string& strOptionName, int& refVal);
     CEnvBase& Bind(const std::string& strOptionName, double& refVal);
-    CEnvBase& Bind(const std::string& strOptionName, std::vector<std::string>& refVal);
-    CEnvBase& Bind(const std::string& strOptionName, std::vector<int>& refVal);
-    CEnvBase& Bind(const std::string& strOptionName, std::vector<double>& refVal);
-
-    /** Clear received argument, may be called before another Feed(); */
-    void ClearArgument();
-
-    void ClearError();
-
-    /** Check if has any error. */
-    bool HasError() { return !m_stError; }
+    CEnvBase& Bind(const std::string& strOptionName, int64_t& refVal);
+    CEnvBase& Bind(const std::string& strOptionName, uint64_t& refVal);
+    CEnvBase& Bind(const std::string& strOptionName, float& refVal);
+    CEnvBase& Bind(const std::string& strOptionName, std::vector<std::string>& refVal, char cDelimiter = '\0');
+    CEnvBase& Bind(const std::string& strOptionName, std::vector<int>& refVal, char cDelimiter = '\0');
+    CEnvBase& Bind(const std::string& strOptionName, std::vector<double>& refVal, char cDelimiter = '\0');
 
     /** Catch one error code.
      * @param [IN] code: one error code, @ref enum ErrorCode
@@ -430,85 +1541,94 @@ public:
     /** Ingore an array of error code. */
     CEnvBase& Ignore(int* code, int size);
 
-private:
-    /** Parse cmdline .
-     * @param [IN] vecArgs: cmdline argument stored in vector.
-     * @param [IN] pos: parse argument from pos, default parese all.
+    /** Watch the config file for change, by inotify and SIGHUP.
+     * @param [IN] fnChanged: called with changed options after reload.
+     * @return int: the inotify fd that can be polled in event loop, or -1 if
+     * only SIGHUP is watched.
+     * @note Should call after Feed(), and then call CheckConfig() in the
+     * thread that reads the bound variables.
+     * */
+    int WatchConfig(FConfigChanged fnChanged = nullptr);
+
+    /** Reload config if the file is changed or SIGHUP received, not block.
+     * @return int: error code of ReloadConfig(), or 0 if not changed.
+     * */
+    int CheckConfig();
+
+    /** Read config file again, and re-bind only the changed options.
      * @return int: error code 0 for success.
-     * @note When without any option setting,
-     * any short name consider as flag with no argument, and long name
-     * has argument. After read cmdline, flag can also Get() by short name,
-     * since donnot known it's corresponding long name.
-     * @note Setup options and sub-command if any before call this when possible.
-     * @note May parse from pos 1 for sub-command.
-     * @note @ref Feed() whill call this.
+     * @details The options from cmdline keep precedence and are not changed,
+     * other option is compared to the new value from config, if different,
+     * replace the received value and resolve its bound variable, then call
+     * the callback set by WatchConfig() with all changed option names.
+     * @note Option removed from config falls back to environment or default,
+     * and its bound variable is reset to zero value if there is no default.
+     * Unknown option and position argument in config are not reloaded.
+     * @note All changed values are checked before any variable is written,
+     * if one fails to convert, nothing is changed and the error returned.
      * */
-    int ParseCmdline(const std::vector<std::string>& vecArgs, size_t pos = 0);
+    int ReloadConfig();
 
-    /** Resolve all bind variable.
-     * @note must called after Feed() or Prase method.
+    /** Publish snapshot of parse result after each successful Feed() and
+     * ReloadConfig(), for threads that read options concurrently.
+     * @return *this
+     * @note Bound variables are still written in place, reader threads
+     * should use @ref CSnapshotReader on Publisher() instead.
      * */
-    void GetBind();
+    CEnvBase& PublishSnapshot(bool bEnable = true);
 
-    /** Find option setting by name. */
-    COption* FindOption(char cShortName);
-    COption* FindOption(const std::string& strLongName);
+    /** Get the publisher to create @ref CSnapshotReader. */
+    const CSnapshotPublisher& Publisher() const { return m_stPublisher; }
 
-    /** Find sub command by name. */
-    CommandInfo* FindCommand(const std::string& strName);
+protected:
+    /** Print help for main command, but let sub-command handler deal with. */
+    virtual bool OnHelp(bool bVersion) override;
 
-    /** Find sub command from argv[1] or argv[0].
-     * If argv[1] available sub command, `iShift` is set to 1.
-     * */
-    CommandInfo* FindCommand(int argc, const char* argv[], int& iShift);
+    /** Resolve all bind variable. */
+    virtual void OnReceived() override;
 
-    /** Save received position argument. */
-    void SaveArgument(const std::string& strArg);
+    /** Resolve one bind variable, return false if caught error. */
+    bool BindValue(const std::string& strOptionName, const COptionBind& stBind);
 
-    /** Save received option argument or flag without argument.
-     * Non-repeated option can only be save once, the first once take effect.
-     * */
-    void SaveOption(char cShortName);
-    void SaveOption(const std::string& strLongName, const std::string& strArg);
-    void SaveOption(const COption& stOption);
-    void SaveOption(const COption& stOption, const std::string& strArg);
+    /** Check the value of bound option can convert, not write the variable. */
+    bool CheckBindValue(const std::string& strOptionName, const COptionBind& stBind);
 
-    /** Check if the argument for option in valid. */
-    bool CheckOptionArgument(const std::string& strArg);
+    /** Reset bound variable to its zero value, or empty list. */
+    void ResetBindValue(const COptionBind& stBind);
 
-    /** Check if all required options are provided. */
-    bool CheckRequiredOption();
+    /** Print statistics if `--cliop-stats` received. */
+    void PrintStats();
 
-    /** Check if all option have been setup. */
-    bool CheckUnknownOption();
+private:
+    /** Get the option setup to modify, copy if it is shared. */
+    CEnvSpec& Setup();
 
-    /** Move some postion argument to option argument as setup.
-     * Only move the first several continuous argument(s) to option if they
-     * are not provided explicitly. Only move real cmdline argument, but not
-     * thar read from config file, as you should edit config file clearly.
+    /** Convert all values of option and append to bound list if all valid.
+     * @param [IN] cDelimiter: split each value by it if not 0.
+     * @param [OUT] strError: the first invalid value.
+     * @return int: @ref util::ENumberParse of the first invalid value.
      * */
-    void MoveArgument();
+    template <typename valueT>
+    int BindList(const std::string& strOptionName, std::vector<valueT>& vecBind, char cDelimiter, util::CStrView& strError);
 
-    /** Read option/argument lines from config file.
-     * @param [IN] strFile: config file path
-     * @param [OUT] cfgArgs: save each line as a cmdline option or argument
-     * @details
-     * Normal cmdline arguments are separated by space, while
-     * arguments in config file are separate by line. The config file is
-     * compatible with ini file, where each `key=val` is just treated as
-     * `--key=val` in cmdline. The section `[group]` is prefix of each key
-     * under this group, as `--group.key=val`, but section is not necessary.
-     * Config file can has commet lines begin with `#` or `;`, and space are
-     * allowed around `=` or begin or end of line. The lines without `=` are
-     * considered as normal argument except section line.
-     * Special `--` or `[--]` is used to marked the following lines are all
-     * normal argument except comment line.
-     * @note If cannot read config file, just silent ignore.
-     * @note Also skip read any config if specify --config=NONE
+    /** Create the handler object of sub command by factory or plugin.
+     * @return bool: false if plugin cannot load, or no object created.
      * */
-    void ReadConfig(const std::string& strFile, std::vector<std::string>& cfgArgs);
+    bool CreateCommand(CommandInfo& stCommand);
 
-    /** reserved option: --help --config --version. */
+    /** Find sub command by name, in hash index. */
+    CommandInfo* FindCommand(const util::CStrView& strName);
+
+    /** Find sub command from argv[1] or argv[0].
+     * If argv[1] available sub command, `iShift` is set to 1.
+     * @note For multi-call binary invoked by symlink, argv[0] may be a path,
+     * then try its base name, and at last `program_invocation_short_name`.
+     * */
+    CommandInfo* FindCommand(int argc, const char* argv[], int& iShift);
+
+    /** reserved option: --help --config --version, and --cliop-stats if enabled.
+     * @note Only called in Freeze().
+     * */
     void ReservedOption();
 
 public:
@@ -1,9 +1,28 @@
 #include "util-string.h"
 #include <ctype.h>
+#include <errno.h>
+#include <float.h>
+#include <limits.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <cmath>
+#include <ostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace util
 {
 
+std::ostream& operator<<(std::ostream& os, const CStrView& view)
+{
+    return os.write(view.data(), view.size());
+}
+
 int Split(const std::string& strSrc, std::vector<std::string>& vecDest, char cSeparator)
 {
     size_t iBegin = 0;
@@ -162,6 +181,690 @@ int Trim(std::string& strSrc)
     return iSize - strSrc.size();
 }
 
+// value of a digit char in base 10 or 16, or -1 if invalid
+template <int iBase>
+static inline int DigitValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (iBase == 16 && c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (iBase == 16 && c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// parse unsigned digits from `iBegin` to end, constant base for fast multiply
+template <int iBase>
+static int ParseDigitsBase(const CStrView& strSrc, size_t iBegin, uint64_t& outVal)
+{
+    const uint64_t uLimit = UINT64_MAX / iBase;
+    uint64_t uVal = 0;
+    bool bOverflow = false;
+    for (size_t i = iBegin; i < strSrc.size(); ++i)
+    {
+        int iDigit = DigitValue<iBase>(strSrc[i]);
+        if (iDigit < 0)
+        {
+            return NUMBER_INVALID;
+        }
+        if (uVal > uLimit || uVal * iBase > UINT64_MAX - iDigit)
+        {
+            bOverflow = true;
+        }
+        uVal = uVal * iBase + iDigit;
+    }
+
+    outVal = bOverflow ? UINT64_MAX : uVal;
+    return bOverflow ? NUMBER_OVERFLOW : NUMBER_OK;
+}
+
+// parse unsigned digits in decimal, or hex with prefix 0x
+static int ParseDigits(const CStrView& strSrc, size_t iBegin, uint64_t& outVal)
+{
+    if (iBegin >= strSrc.size())
+    {
+        return NUMBER_INVALID;
+    }
+    if (strSrc.size() - iBegin > 2 && strSrc[iBegin] == '0' && (strSrc[iBegin+1] == 'x' || strSrc[iBegin+1] == 'X'))
+    {
+        return ParseDigitsBase<16>(strSrc, iBegin + 2, outVal);
+    }
+    return ParseDigitsBase<10>(strSrc, iBegin, outVal);
+}
+
+int ParseNumber(const CStrView& strSrc, uint64_t& outVal)
+{
+    size_t iBegin = (!strSrc.empty() && strSrc[0] == '+') ? 1 : 0;
+    return ParseDigits(strSrc, iBegin, outVal);
+}
+
+int ParseNumber(const CStrView& strSrc, int64_t& outVal)
+{
+    bool bNegative = !strSrc.empty() && strSrc[0] == '-';
+    size_t iBegin = (!strSrc.empty() && (strSrc[0] == '+' || strSrc[0] == '-')) ? 1 : 0;
+    uint64_t uVal = 0;
+    int iRet = ParseDigits(strSrc, iBegin, uVal);
+    if (iRet == NUMBER_INVALID)
+    {
+        return iRet;
+    }
+
+    const uint64_t uMax = static_cast<uint64_t>(INT64_MAX);
+    if (bNegative)
+    {
+        if (iRet == NUMBER_OVERFLOW || uVal > uMax + 1)
+        {
+            outVal = INT64_MIN;
+            return NUMBER_OVERFLOW;
+        }
+        outVal = uVal == uMax + 1 ? INT64_MIN : -static_cast<int64_t>(uVal);
+    }
+    else
+    {
+        if (iRet == NUMBER_OVERFLOW || uVal > uMax)
+        {
+            outVal = INT64_MAX;
+            return NUMBER_OVERFLOW;
+        }
+        outVal = static_cast<int64_t>(uVal);
+    }
+    return NUMBER_OK;
+}
+
+int ParseNumber(const CStrView& strSrc, int& outVal)
+{
+    int64_t iVal = 0;
+    int iRet = ParseNumber(strSrc, iVal);
+    if (iRet == NUMBER_INVALID)
+    {
+        return iRet;
+    }
+    if (iVal > INT_MAX || iVal < INT_MIN)
+    {
+        outVal = iVal > 0 ? INT_MAX : INT_MIN;
+        return NUMBER_OVERFLOW;
+    }
+    outVal = static_cast<int>(iVal);
+    return iRet;
+}
+
+// match word case-insensitive, the word is in lower case
+static bool MatchWord(const CStrView& strSrc, size_t iBegin, const char* pszWord)
+{
+    size_t nSize = strlen(pszWord);
+    if (strSrc.size() - iBegin != nSize)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < nSize; ++i)
+    {
+        char c = strSrc[iBegin + i];
+        if (c >= 'A' && c <= 'Z')
+        {
+            c = c - 'A' + 'a';
+        }
+        if (c != pszWord[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// fallback when the fast path is not exact, strtod in "C" locale
+static int ParseDoubleSlow(const CStrView& strSrc, double& outVal)
+{
+    static locale_t s_locale = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+    std::string strCopy = strSrc.ToString();
+    char* pEnd = nullptr;
+    errno = 0;
+    double fVal = strtod_l(strCopy.c_str(), &pEnd, s_locale);
+    if (pEnd != strCopy.c_str() + strCopy.size())
+    {
+        return NUMBER_INVALID;
+    }
+    outVal = fVal;
+    if (errno == ERANGE && std::isinf(fVal))
+    {
+        return NUMBER_OVERFLOW;
+    }
+    return NUMBER_OK;
+}
+
+int ParseNumber(const CStrView& strSrc, double& outVal)
+{
+    size_t i = 0;
+    bool bNegative = false;
+    if (i < strSrc.size() && (strSrc[i] == '+' || strSrc[i] == '-'))
+    {
+        bNegative = strSrc[i] == '-';
+        ++i;
+    }
+    if (MatchWord(strSrc, i, "inf") || MatchWord(strSrc, i, "infinity"))
+    {
+        outVal = bNegative ? -HUGE_VAL : HUGE_VAL;
+        return NUMBER_OK;
+    }
+    if (MatchWord(strSrc, i, "nan"))
+    {
+        outVal = NAN;
+        return NUMBER_OK;
+    }
+
+    // at most 19 significant digits can be saved in uint64_t
+    uint64_t uMantissa = 0;
+    int nSignificant = 0;
+    int iExponent = 0;
+    bool bTruncated = false;
+    int nDigits = 0;
+    for (; i < strSrc.size() && strSrc[i] >= '0' && strSrc[i] <= '9'; ++i, ++nDigits)
+    {
+        if (nSignificant < 19)
+        {
+            uMantissa = uMantissa * 10 + (strSrc[i] - '0');
+            nSignificant += uMantissa > 0 ? 1 : 0;
+        }
+        else
+        {
+            iExponent++;
+            bTruncated = bTruncated || strSrc[i] != '0';
+        }
+    }
+    if (i < strSrc.size() && strSrc[i] == '.')
+    {
+        for (++i; i < strSrc.size() && strSrc[i] >= '0' && strSrc[i] <= '9'; ++i, ++nDigits)
+        {
+            if (nSignificant < 19)
+            {
+                uMantissa = uMantissa * 10 + (strSrc[i] - '0');
+                nSignificant += uMantissa > 0 ? 1 : 0;
+                iExponent--;
+            }
+            else
+            {
+                bTruncated = bTruncated || strSrc[i] != '0';
+            }
+        }
+    }
+    if (nDigits == 0)
+    {
+        return NUMBER_INVALID;
+    }
+
+    if (i < strSrc.size() && (strSrc[i] == 'e' || strSrc[i] == 'E'))
+    {
+        ++i;
+        bool bExpNegative = false;
+        if (i < strSrc.size() && (strSrc[i] == '+' || strSrc[i] == '-'))
+        {
+            bExpNegative = strSrc[i] == '-';
+            ++i;
+        }
+        if (i >= strSrc.size())
+        {
+            return NUMBER_INVALID;
+        }
+        int iExp = 0;
+        for (; i < strSrc.size() && strSrc[i] >= '0' && strSrc[i] <= '9'; ++i)
+        {
+            if (iExp < 100000)
+            {
+                iExp = iExp * 10 + (strSrc[i] - '0');
+            }
+        }
+        iExponent += bExpNegative ? -iExp : iExp;
+    }
+    if (i != strSrc.size())
+    {
+        return NUMBER_INVALID;
+    }
+
+    // exact when both mantissa and power of 10 are exact in double
+    static const double s_aPow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    if (!bTruncated && uMantissa <= (1ull << 53) && iExponent >= -22 && iExponent <= 22)
+    {
+        double fVal = static_cast<double>(uMantissa);
+        fVal = iExponent < 0 ? fVal / s_aPow10[-iExponent] : fVal * s_aPow10[iExponent];
+        outVal = bNegative ? -fVal : fVal;
+        return NUMBER_OK;
+    }
+    if (uMantissa == 0)
+    {
+        outVal = bNegative ? -0.0 : 0.0;
+        return NUMBER_OK;
+    }
+
+    return ParseDoubleSlow(strSrc, outVal);
+}
+
+int ParseNumber(const CStrView& strSrc, float& outVal)
+{
+    double fVal = 0;
+    int iRet = ParseNumber(strSrc, fVal);
+    if (iRet == NUMBER_INVALID)
+    {
+        return iRet;
+    }
+    if (!std::isinf(fVal) && (fVal > FLT_MAX || fVal < -FLT_MAX))
+    {
+        outVal = fVal > 0 ? HUGE_VALF : -HUGE_VALF;
+        return NUMBER_OVERFLOW;
+    }
+    outVal = static_cast<float>(fVal);
+    return iRet;
+}
+
+size_t CountChar(const CStrView& strSrc, char c)
+{
+    const char* pData = strSrc.data();
+    size_t nSize = strSrc.size();
+    size_t nCount = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i vChar = _mm_set1_epi8(c);
+    for (; i + 16 <= nSize; i += 16)
+    {
+        __m128i vData = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i));
+        unsigned int uMask = _mm_movemask_epi8(_mm_cmpeq_epi8(vData, vChar));
+        nCount += __builtin_popcount(uMask);
+    }
+#endif
+    for (; i < nSize; ++i)
+    {
+        nCount += (pData[i] == c) ? 1 : 0;
+    }
+    return nCount;
+}
+
+template <typename valueT>
+static int SplitNumberImpl(const CStrView& strSrc, std::vector<valueT>& vecDest, char cSeparator)
+{
+    if (strSrc.empty())
+    {
+        return NUMBER_OK;
+    }
+    // ignore the last separator in the very end
+    CStrView strList = strSrc.back() == cSeparator ? strSrc.substr(0, strSrc.size() - 1) : strSrc;
+    size_t nItem = CountChar(strList, cSeparator) + 1;
+    size_t nOrigin = vecDest.size();
+    vecDest.resize(nOrigin + nItem);
+
+    valueT* pDest = vecDest.data() + nOrigin;
+    const char* pBegin = strList.data();
+    const char* pEnd = pBegin + strList.size();
+    for (size_t k = 0; k < nItem; ++k)
+    {
+        const char* pSep = static_cast<const char*>(memchr(pBegin, cSeparator, pEnd - pBegin));
+        if (pSep == nullptr)
+        {
+            pSep = pEnd;
+        }
+        int iRet = ParseNumber(CStrView(pBegin, pSep - pBegin), pDest[k]);
+        if (iRet != NUMBER_OK)
+        {
+            vecDest.resize(nOrigin);
+            return iRet;
+        }
+        pBegin = pSep + 1;
+    }
+    return NUMBER_OK;
+}
+
+int SplitNumber(const CStrView& strSrc, std::vector<int>& vecDest, char cSeparator)
+{
+    return SplitNumberImpl(strSrc, vecDest, cSeparator);
+}
+
+int SplitNumber(const CStrView& strSrc, std::vector<int64_t>& vecDest, char cSeparator)
+{
+    return SplitNumberImpl(strSrc, vecDest, cSeparator);
+}
+
+int SplitNumber(const CStrView& strSrc, std::vector<double>& vecDest, char cSeparator)
+{
+    return SplitNumberImpl(strSrc, vecDest, cSeparator);
+}
+
+CStrView TrimView(const CStrView& strSrc)
+{
+    size_t iBegin = 0;
+    size_t iEnd = strSrc.size();
+    while (iBegin < iEnd && isspace(static_cast<unsigned char>(strSrc[iBegin])))
+    {
+        iBegin++;
+    }
+    while (iEnd > iBegin && isspace(static_cast<unsigned char>(strSrc[iEnd - 1])))
+    {
+        iEnd--;
+    }
+    return strSrc.substr(iBegin, iEnd - iBegin);
+}
+
+// append the char escaped by backslash in double quote
+static void AppendEscape(std::string& strBuffer, char cNext)
+{
+    switch (cNext)
+    {
+    case 'n': strBuffer.push_back('\n'); break;
+    case 't': strBuffer.push_back('\t'); break;
+    case 'r': strBuffer.push_back('\r'); break;
+    case '\\':
+    case '"':
+    case '\'':
+        strBuffer.push_back(cNext);
+        break;
+    default:
+        strBuffer.push_back('\\');
+        strBuffer.push_back(cNext);
+        break;
+    }
+}
+
+static inline bool IsTokenSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+CStrView Unquote(const CStrView& strSrc, std::string& strBuffer)
+{
+    if (strSrc.size() < 2 || strSrc.front() != strSrc.back()
+            || (strSrc.front() != '"' && strSrc.front() != '\''))
+    {
+        return strSrc;
+    }
+    CStrView strInner = strSrc.substr(1, strSrc.size() - 2);
+    if (strSrc.front() == '\'' || strInner.find('\\') == CStrView::npos)
+    {
+        return strInner;
+    }
+
+    strBuffer.clear();
+    for (size_t i = 0; i < strInner.size(); ++i)
+    {
+        char c = strInner[i];
+        if (c != '\\' || i + 1 == strInner.size())
+        {
+            strBuffer.push_back(c);
+            continue;
+        }
+        AppendEscape(strBuffer, strInner[++i]);
+    }
+    return strBuffer;
+}
+
+bool CLineReader::Open(const std::string& strFile)
+{
+    Close();
+    int fd = open(strFile.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat stStat;
+    if (fstat(fd, &stStat) != 0 || S_ISDIR(stStat.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+    if (S_ISREG(stStat.st_mode) && stStat.st_size > 0)
+    {
+        void* pMap = mmap(nullptr, stStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pMap != MAP_FAILED)
+        {
+            madvise(pMap, stStat.st_size, MADV_SEQUENTIAL);
+            m_pMap = pMap;
+            m_pData = static_cast<const char*>(pMap);
+            m_nSize = stStat.st_size;
+        }
+    }
+
+    // empty or special file, read in large chunks
+    if (m_pMap == nullptr)
+    {
+        char szChunk[65536];
+        ssize_t nRead = 0;
+        while ((nRead = read(fd, szChunk, sizeof(szChunk))) > 0)
+        {
+            m_strBuffer.append(szChunk, nRead);
+        }
+        m_pData = m_strBuffer.data();
+        m_nSize = m_strBuffer.size();
+    }
+
+    close(fd);
+    m_bOpen = true;
+    return true;
+}
+
+void CLineReader::Close()
+{
+    if (m_pMap != nullptr)
+    {
+        munmap(m_pMap, m_nSize);
+        m_pMap = nullptr;
+    }
+    m_strBuffer.clear();
+    m_pData = nullptr;
+    m_nSize = 0;
+    m_iPos = 0;
+    m_bOpen = false;
+}
+
+bool CLineReader::Next(CStrView& strLine)
+{
+    if (m_iPos >= m_nSize)
+    {
+        return false;
+    }
+    const char* pBegin = m_pData + m_iPos;
+    size_t nLeft = m_nSize - m_iPos;
+    const char* pEnd = static_cast<const char*>(memchr(pBegin, '\n', nLeft));
+    size_t nLine = pEnd == nullptr ? nLeft : pEnd - pBegin;
+    m_iPos += (pEnd == nullptr) ? nLine : nLine + 1;
+    if (nLine > 0 && pBegin[nLine - 1] == '\r')
+    {
+        nLine--;
+    }
+    strLine = CStrView(pBegin, nLine);
+    return true;
+}
+
+bool NextToken(const CStrView& strSrc, size_t& iPos, CStrView& strToken, std::string& strBuffer)
+{
+    const char* pData = strSrc.data();
+    size_t nSize = strSrc.size();
+    while (iPos < nSize && IsTokenSpace(pData[iPos]))
+    {
+        iPos++;
+    }
+    if (iPos >= nSize)
+    {
+        return false;
+    }
+
+    size_t iBegin = iPos;
+    while (iPos < nSize && !IsTokenSpace(pData[iPos]) && pData[iPos] != '"' && pData[iPos] != '\'')
+    {
+        iPos++;
+    }
+    if (iPos == nSize || IsTokenSpace(pData[iPos]))
+    {
+        strToken = CStrView(pData + iBegin, iPos - iBegin);
+        return true;
+    }
+
+    strBuffer.assign(pData + iBegin, iPos - iBegin);
+    char cQuote = '\0';
+    while (iPos < nSize)
+    {
+        char c = pData[iPos++];
+        if (cQuote == '\0')
+        {
+            if (IsTokenSpace(c))
+            {
+                break;
+            }
+            if (c == '"' || c == '\'')
+            {
+                cQuote = c;
+            }
+            else
+            {
+                strBuffer.push_back(c);
+            }
+        }
+        else if (c == cQuote)
+        {
+            cQuote = '\0';
+        }
+        else if (c == '\\' && cQuote == '"' && iPos < nSize)
+        {
+            AppendEscape(strBuffer, pData[iPos++]);
+        }
+        else
+        {
+            strBuffer.push_back(c);
+        }
+    }
+    strToken = strBuffer;
+    return true;
+}
+
+bool CTokenReader::Open(const std::string& strFile)
+{
+    Close();
+    int fd = open(strFile.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat stStat;
+    if (fstat(fd, &stStat) != 0 || S_ISDIR(stStat.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+    Attach(fd);
+    m_bOwnFd = true;
+    return true;
+}
+
+void CTokenReader::Attach(int fd)
+{
+    Close();
+    m_fd = fd;
+    m_strChunk.resize(65536);
+}
+
+void CTokenReader::Close()
+{
+    if (m_bOwnFd && m_fd >= 0)
+    {
+        close(m_fd);
+    }
+    m_fd = -1;
+    m_bOwnFd = false;
+    m_iPos = 0;
+    m_nSize = 0;
+}
+
+bool CTokenReader::Fill()
+{
+    m_iPos = 0;
+    m_nSize = 0;
+    if (m_fd < 0)
+    {
+        return false;
+    }
+    ssize_t nRead = 0;
+    do
+    {
+        nRead = read(m_fd, &m_strChunk[0], m_strChunk.size());
+    } while (nRead < 0 && errno == EINTR);
+    if (nRead <= 0)
+    {
+        return false;
+    }
+    m_nSize = nRead;
+    return true;
+}
+
+
+bool CTokenReader::Next(CStrView& strToken)
+{
+    do
+    {
+        while (m_iPos < m_nSize && IsTokenSpace(m_strChunk[m_iPos]))
+        {
+            m_iPos++;
+        }
+    } while (m_iPos == m_nSize && Fill());
+    if (m_iPos == m_nSize)
+    {
+        return false;
+    }
+
+    // most token has no quote and end in the chunk, refer to it directly
+    const char* pData = m_strChunk.data();
+    size_t iBegin = m_iPos;
+    while (m_iPos < m_nSize && !IsTokenSpace(pData[m_iPos]) && pData[m_iPos] != '"' && pData[m_iPos] != '\'')
+    {
+        m_iPos++;
+    }
+    if (m_iPos < m_nSize && IsTokenSpace(pData[m_iPos]))
+    {
+        strToken = CStrView(pData + iBegin, m_iPos - iBegin);
+        return true;
+    }
+
+    m_strToken.assign(pData + iBegin, m_iPos - iBegin);
+    char cQuote = '\0';
+    while (m_iPos < m_nSize || Fill())
+    {
+        char c = m_strChunk[m_iPos++];
+        if (cQuote == '\0')
+        {
+            if (IsTokenSpace(c))
+            {
+                break;
+            }
+            if (c == '"' || c == '\'')
+            {
+                cQuote = c;
+            }
+            else
+            {
+                m_strToken.push_back(c);
+            }
+        }
+        else if (c == cQuote)
+        {
+            cQuote = '\0';
+        }
+        else if (c == '\\' && cQuote == '"' && (m_iPos < m_nSize || Fill()))
+        {
+            AppendEscape(m_strToken, m_strChunk[m_iPos++]);
+        }
+        else
+        {
+            m_strToken.push_back(c);
+        }
+    }
+    strToken = m_strToken;
+    return true;
+}
+
 CTextAlign& CTextAlign::AddLine(std::vector<std::string>& line)
 {
     m_vLine.push_back(std::move(line));
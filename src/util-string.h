@@ -9,9 +9,79 @@
 
 #include <string>
 #include <vector>
+#include <iosfwd>
+#include <string.h>
+#include <stdint.h>
 
 namespace util
 {
+/** Light reference to part of a string, not own the memory.
+ * @note It is used as a C++11 replacement of std::string_view, so keep the
+ * similar lower case method name as std::string.
+ * @note The referred memory must live longer than the view object.
+ * */
+class CStrView
+{
+    const char* m_pData = "";
+    size_t m_nSize = 0;
+
+public:
+    static const size_t npos = std::string::npos;
+
+    CStrView() {}
+    CStrView(const char* pData, size_t nSize) : m_pData(pData), m_nSize(nSize) {}
+    CStrView(const char* psz) : m_pData(psz), m_nSize(strlen(psz)) {}
+    CStrView(const std::string& str) : m_pData(str.data()), m_nSize(str.size()) {}
+
+    const char* data() const { return m_pData; }
+    size_t size() const { return m_nSize; }
+    bool empty() const { return m_nSize == 0; }
+    char operator[](size_t i) const { return m_pData[i]; }
+    char front() const { return m_pData[0]; }
+    char back() const { return m_pData[m_nSize - 1]; }
+
+    /** Sub view from `pos` with at most `n` chars. */
+    CStrView substr(size_t pos, size_t n = npos) const
+    {
+        if (pos > m_nSize)
+        {
+            pos = m_nSize;
+        }
+        if (n > m_nSize - pos)
+        {
+            n = m_nSize - pos;
+        }
+        return CStrView(m_pData + pos, n);
+    }
+
+    /** Find a char from `pos`, return npos if not found. */
+    size_t find(char c, size_t pos = 0) const
+    {
+        if (pos >= m_nSize)
+        {
+            return npos;
+        }
+        const void* p = memchr(m_pData + pos, c, m_nSize - pos);
+        return p == nullptr ? npos : static_cast<const char*>(p) - m_pData;
+    }
+
+    /** Materialize a std::string copy. */
+    std::string ToString() const { return std::string(m_pData, m_nSize); }
+    explicit operator std::string() const { return ToString(); }
+};
+
+inline bool operator==(const CStrView& lhs, const CStrView& rhs)
+{
+    return lhs.size() == rhs.size() && memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+inline bool operator!=(const CStrView& lhs, const CStrView& rhs)
+{
+    return !(lhs == rhs);
+}
+
+std::ostream& operator<<(std::ostream& os, const CStrView& view);
+
 /** Split string by a specific char.
  * @param [IN] strSrc: the source string to be split.
  * @param [OUT] vecDesc: save the splitted string to a vector.
@@ -71,6 +141,142 @@ int TrimRight(std::string& strSrc);
  * */
 int Trim(std::string& strSrc);
 
+/** Trim the white space of a string view in both ends, without copy. */
+CStrView TrimView(const CStrView& strSrc);
+
+/** Remove the quote pair around string, and unescape in double quote.
+ * @param [IN] strSrc: the string may be quoted as "..." or '...'.
+ * @param [OUT] strBuffer: save the unescaped string only if needed.
+ * @return CStrView: refer to `strSrc` or `strBuffer`.
+ * @details Single quote is literal. In double quote, escape `\n`, `\t`,
+ * `\r`, `\\`, `\"` and `\'`, other backslash is kept as it is.
+ * */
+CStrView Unquote(const CStrView& strSrc, std::string& strBuffer);
+
+/** Get the next whitespace separated token from string, as a cmdline.
+ * @param [IN] strSrc: the string to split, such as a line of cmdline.
+ * @param [IN-OUT] iPos: begin to find token, set to the end of token.
+ * @param [OUT] strToken: refer to `strSrc`, or `strBuffer` if quoted.
+ * @param [OUT] strBuffer: save the token only if quoted.
+ * @return bool: false if no more token.
+ * @details Token can contain quoted part as @ref CTokenReader.
+ * */
+bool NextToken(const CStrView& strSrc, size_t& iPos, CStrView& strToken, std::string& strBuffer);
+
+/** Result of parsing number from string. */
+enum ENumberParse
+{
+    NUMBER_OK = 0,      //< the whole string is a valid number
+    NUMBER_INVALID,     //< empty or has any invalid char
+    NUMBER_OVERFLOW,    //< valid number but out of range of the type
+};
+
+/** Parse the whole string as number, independent of locale.
+ * @param [IN] strSrc: the string, no space allowed in any end.
+ * @param [OUT] outVal: the parsed number.
+ * @return int: @ref ENumberParse
+ * @details Integer may has sign `+` or `-`, and prefix `0x` for hex, leading
+ * `0` is still decimal. Float number may has fraction and exponent part as
+ * `-1.5e3`, or be `inf`, `nan` case-insensitive.
+ * @note `outVal` is unchanged if invalid, and set to the limit if overflow.
+ * */
+int ParseNumber(const CStrView& strSrc, int64_t& outVal);
+int ParseNumber(const CStrView& strSrc, uint64_t& outVal);
+int ParseNumber(const CStrView& strSrc, int& outVal);
+int ParseNumber(const CStrView& strSrc, double& outVal);
+int ParseNumber(const CStrView& strSrc, float& outVal);
+
+/** Count the occurrence of a char in string, vectorized if SSE2 available. */
+size_t CountChar(const CStrView& strSrc, char c);
+
+/** Split string by a separator char and convert each item to number.
+ * @param [IN] strSrc: the source string to be split.
+ * @param [OUT] vecDest: append the converted numbers to vector.
+ * @param [IN] cSeparator: the separator char.
+ * @return int: @ref ENumberParse of the first invalid item.
+ * @details Count separators first to resize `vecDest` once, then convert
+ * each item in place by @ref ParseNumber(), without copy item string.
+ * @note Follow the rule of @ref Split() for empty item, and if any item is
+ * invalid, `vecDest` is restored to the original size.
+ * */
+int SplitNumber(const CStrView& strSrc, std::vector<int>& vecDest, char cSeparator);
+int SplitNumber(const CStrView& strSrc, std::vector<int64_t>& vecDest, char cSeparator);
+int SplitNumber(const CStrView& strSrc, std::vector<double>& vecDest, char cSeparator);
+
+/** Read text file line by line, each line as a view without copy.
+ * @details The file is memory mapped, or read into one buffer if cannot map,
+ * so the lines are valid until the reader is closed.
+ * */
+class CLineReader
+{
+    const char* m_pData = nullptr; //< file content
+    size_t m_nSize = 0;            //< file size
+    size_t m_iPos = 0;             //< begin of next line
+    void* m_pMap = nullptr;        //< mapped address, or null if read
+    std::string m_strBuffer;       //< file content if not mapped
+    bool m_bOpen = false;
+
+public:
+    CLineReader() {}
+    explicit CLineReader(const std::string& strFile) { Open(strFile); }
+    ~CLineReader() { Close(); }
+    CLineReader(const CLineReader&) = delete;
+    CLineReader& operator=(const CLineReader&) = delete;
+
+    /** Open file to read, return false if cannot read. */
+    bool Open(const std::string& strFile);
+    void Close();
+    bool IsOpen() const { return m_bOpen; }
+
+    /** The whole content of file, to read other than line. */
+    CStrView Content() const { return CStrView(m_nSize > 0 ? m_pData : "", m_nSize); }
+
+    /** Get the next line, without line end `\n` or `\r\n`.
+     * @return bool: false if no more line.
+     * */
+    bool Next(CStrView& strLine);
+};
+
+/** Read whitespace separated tokens from file descriptor, in chunks.
+ * @details Token can contain quoted part as `"..."` or `'...'`, the quote is
+ * removed and escape in double quote as @ref Unquote(). Only one chunk is
+ * buffered, so it can read large file or pipe without loading it whole.
+ * */
+class CTokenReader
+{
+    int m_fd = -1;                 //< file descriptor to read
+    bool m_bOwnFd = false;         //< close m_fd when closed
+    std::string m_strChunk;        //< buffer of the last read chunk
+    size_t m_iPos = 0;             //< begin of unread in chunk
+    size_t m_nSize = 0;            //< size of data in chunk
+    std::string m_strToken;        //< token quoted or cross chunks
+
+public:
+    CTokenReader() {}
+    ~CTokenReader() { Close(); }
+    CTokenReader(const CTokenReader&) = delete;
+    CTokenReader& operator=(const CTokenReader&) = delete;
+
+    /** Open file to read, return false if cannot read. */
+    bool Open(const std::string& strFile);
+
+    /** Read from opened fd, such as 0 for stdin, not closed by this. */
+    void Attach(int fd);
+
+    void Close();
+    bool IsOpen() const { return m_fd >= 0; }
+
+    /** Get the next token.
+     * @return bool: false if no more token.
+     * @note The view is valid until next call.
+     * */
+    bool Next(CStrView& strToken);
+
+private:
+    /** Read next chunk, return false if end of file. */
+    bool Fill();
+};
+
 /** Format text, align with each column width as much as possible. */
 class CTextAlign
 {
@@ -0,0 +1,38 @@
+/**
+ * @file test-plugin.cpp
+ * @author lymslive
+ * @date 2022-05-12
+ * @brief Sub-command plugin for test, loaded by utest-cliop on demand.
+ * @note Not linked with cliop, the symbols are resolved from the executable.
+ * */
+#include "cliop.h"
+
+namespace
+{
+
+struct CPluginCommand : public cli::CEnvBase
+{
+    int left = 0;
+    int right = 0;
+
+    CPluginCommand()
+    {
+        Set("-l #1 --left=", "left operand", left);
+        Set("-r #2 --right=", "right operand", right);
+        Set("--config= [NONE]", "no config file");
+    }
+
+    virtual int Run(int, const char*[]) override
+    {
+        return left - right;
+    }
+};
+
+} // namespace
+
+CLIOP_PLUGIN_COMMAND(CPluginCommand)
+
+extern "C" cli::CEnvBase* plugin_null_command()
+{
+    return nullptr;
+}
@@ -0,0 +1,169 @@
+#include "tinytast.hpp"
+#include "cliop.h"
+#include "alloc-hook.h"
+
+namespace
+{
+
+/** The typical setup of a small tool, with bound variables. */
+struct CToolOption
+{
+    bool verbose = false;
+    int number = 0;
+    double ratio = 0;
+    std::string output;
+    std::vector<std::string> expr;
+
+    void Setup(cli::CEnvBase& env)
+    {
+        env.Flag('v', "verbose", "print more message", verbose)
+            .Set("-n --number= [1]", "how many times", number)
+            .Set("-r --ratio= [0.5]", "the ratio", ratio)
+            .Set("-o --output=", "output file", output)
+            .Set("-e --expr=+", "repeated expression", expr)
+            .Set("--config= [NONE]", "no config file");
+    }
+};
+
+const char* s_argvTool[] = {"tool", "-v", "-n", "3", "--ratio=0.8", "-o", "out.txt",
+    "-e", "a", "-e", "b", "in.txt", "more.txt", nullptr};
+const int s_argcTool = sizeof(s_argvTool) / sizeof(s_argvTool[0]) - 1;
+
+/** Let the pointer escape, so that the allocation is not elided. */
+void Sink(const void* p)
+{
+    static const void* volatile s_pSink = nullptr;
+    s_pSink = p;
+}
+
+} // namespace
+
+DEF_TAST(alloc_hook, "test the allocation hook count and peak bytes")
+{
+    bench::CAllocScope scope;
+    COUT(scope.Count(), 0);
+    {
+        std::string strLong(1000, 'x');
+        Sink(strLong.data());
+    }
+    COUT(scope.Count(), 1);
+    COUT(scope.Bytes() >= 1000, true);
+    COUT(scope.Peak() >= 1000, true);
+
+    DESC("peak is the max held at the same time");
+    scope.Reset();
+    for (int i = 0; i < 10; ++i)
+    {
+        std::vector<char> vecBlock(1000);
+        Sink(vecBlock.data());
+    }
+    COUT(scope.Count(), 10);
+    COUT(scope.Bytes() >= 10000, true);
+    COUT(scope.Peak() >= 1000 && scope.Peak() < 2000, true);
+
+    bench::CAllocStat stat = bench::AllocMeasure([]() { std::vector<int> vec(100); Sink(vec.data()); });
+    COUT(stat.m_nCount, 1);
+}
+
+DEF_TAST(alloc_feed_budget, "test allocation budget of typical feed")
+{
+    CToolOption stOption;
+    cli::CEnvBase env;
+    stOption.Setup(env);
+
+    DESC("the first feed build the argument slots");
+    bench::CAllocScope scope;
+    COUT(env.Feed(s_argcTool, s_argvTool), 0);
+    COUT(scope.Count());
+    COUT(scope.Peak());
+    COUT(scope.Count() <= 30, true);
+    COUT(scope.Peak() <= 2048, true);
+
+    DESC("later feed reuse the slots and buffer");
+    for (int i = 0; i < 3; ++i)
+    {
+        // bound list is appended in each feed, clear it as a reused tool does
+        stOption.expr.clear();
+        scope.Reset();
+        COUT(env.Feed(s_argcTool, s_argvTool), 0);
+        COUT(scope.Count(), 0);
+    }
+    COUT(stOption.expr.size(), 2);
+    COUT(stOption.output, std::string("out.txt"));
+
+    DESC("feed from vector keep the tokens in reused buffer");
+    std::vector<std::string> vecArgs = {"-v", "-n", "3", "--ratio=0.8", "-o", "out.txt",
+        "-e", "a", "--user=some.long.name.more.than.sso", "in.txt"};
+    stOption.expr.clear();
+    COUT(env.Feed(vecArgs), 0);
+    stOption.expr.clear();
+    scope.Reset();
+    COUT(env.Feed(vecArgs), 0);
+    COUT(scope.Count(), 0);
+}
+
+DEF_TAST(alloc_get_budget, "test allocation budget of get after feed")
+{
+    CToolOption stOption;
+    cli::CEnvBase env;
+    stOption.Setup(env);
+    COUT(env.Feed({"--number=3", "--output=a.very.long.output.file.name.txt", "in.txt", "--extra=1"}), 0);
+
+    bench::CAllocScope scope;
+    COUT(env.Has("output"), true);
+    COUT(env.Has("verbose"), false);
+    COUT(env.Argc(), 1);
+    COUT(scope.Count(), 0);
+
+    DESC("typed get create the cache only once");
+    COUT(env.Get<int>("number"), 3);
+    COUT(scope.Count() <= 2, true);
+    scope.Reset();
+    COUT(env.Get<int>("number"), 3);
+    COUT(env.Get<double>("ratio"), 0.5);
+    COUT(scope.Count() <= 2, true);
+    COUT(env.Feed({"--number=4", "--config=NONE"}), 0);
+    scope.Reset();
+    COUT(env.Get<int>("number"), 4);
+    COUT(env.Get<double>("ratio"), 0.5);
+    COUT(scope.Count(), 0);
+
+    DESC("string get copy the value, short one in place");
+    COUT(env.Feed({"--number=3", "--output=a.very.long.output.file.name.txt", "in.txt"}), 0);
+    scope.Reset();
+    COUT(env.Get("number"), std::string("3"));
+    COUT(scope.Count(), 0);
+    COUT(env.Get("output").size() > 16, true);
+    COUT(scope.Count(), 1);
+
+    DESC("bound variable is assigned in feed");
+    COUT(stOption.number, 3);
+    COUT(stOption.output, std::string("a.very.long.output.file.name.txt"));
+    std::vector<std::string> vecArgs = {"--number=5", "--ratio=0.1", "-v", "--output=a.very.long.output.file.name.txt"};
+    scope.Reset();
+    COUT(env.Feed(vecArgs), 0);
+    COUT(stOption.number, 5);
+    COUT(stOption.ratio, 0.1);
+    COUT(stOption.verbose, true);
+    COUT(scope.Count() <= 2, true);
+}
+
+DEF_TAST(alloc_context_budget, "test allocation budget of parse context in thread")
+{
+    cli::CEnvBase env;
+    CToolOption stOption;
+    stOption.Setup(env);
+    cli::CParseContext ctx(env.Share());
+
+    bench::CAllocScope scope;
+    COUT(ctx.Feed(s_argcTool, s_argvTool), 0);
+    COUT(scope.Count() <= 30, true);
+    scope.Reset();
+    for (int i = 0; i < 100; ++i)
+    {
+        ctx.Feed(s_argcTool, s_argvTool);
+        ctx.Get<int>("number");
+    }
+    COUT(scope.Count() <= 2, true);
+    COUT(scope.Peak() <= 256, true);
+}
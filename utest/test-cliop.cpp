@@ -2,12 +2,14 @@
 #include "cliop.h"
 #include "util-string.h"
 #include "test-os.h"
-
-std::ostream& operator<<(std::ostream& os, const cli::CArgument& stArgRecv)
-{
-    os << "\n" << stArgRecv.m_mapArgs << "\n" << stArgRecv.m_vecArgs;
-    return os;
-}
+#include "alloc-hook.h"
+#include <chrono>
+#include <fstream>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <thread>
 
 DEF_TAST(cliop_feed1, "test directlly feed argv")
 {
@@ -22,10 +24,10 @@ DEF_TAST(cliop_feed1, "test directlly feed argv")
     COUT(argv[0], "file1");
     COUT(argv[1], "file2");
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
-    COUT(stArgRecv);
+    COUT(env.Args());
+    COUT(env.Argv());
 
-    COUT(stArgRecv.m_mapArgs.size(), 7);
+    COUT(env.Args().size(), 7);
     COUT(env.Has("a"), true);
     COUT(env.Has("b"), true);
     COUT(env.Has("c"), true);
@@ -52,11 +54,11 @@ DEF_TAST(cliop_feed2, "test feed argv having --")
     cli::CEnvBase env;
     env.Feed(vecArgs);
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_vecArgs.size(), 5);
-    COUT(stArgRecv.m_vecArgs[1], "-");
-    COUT(stArgRecv.m_vecArgs[3], "-g");
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Argc(), 5);
+    COUT(env.Argv()[1], "-");
+    COUT(env.Argv()[3], "-g");
 
     COUT(env.Get("abc"), "11");
     COUT(env.Get("efg"), "xyz");
@@ -93,9 +95,9 @@ DEF_TAST(cliop_option1_preset, "custome option setting")
 
     env.Feed(vecArgs);
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_vecArgs.size(), 4);
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Argc(), 4);
 
     DESC("can use short or long name to get option argument");
     COUT(env.Has("a"), true);
@@ -139,9 +141,9 @@ DEF_TAST(cliop_option2_required, "custome and check required option")
     COUT(nFeed, cli::ERROR_CODE_OPTION_REQUIRED);
     COUT(nFeed == 0, false);
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_vecArgs.size(), 2);
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Argc(), 2);
 
     COUT(env.Has("inline"), false);
     COUT(env.Has("good"), true);
@@ -161,9 +163,9 @@ DEF_TAST(cliop_option3_unexpected, "check unexpected option")
     int nFeed = env.Feed(vecArgs);
     COUT(nFeed == 0, true);
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_vecArgs.size(), 2);
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Argc(), 2);
 
     COUT(env.Has("inline"), false);
     COUT(env.Has("good"), false);
@@ -196,9 +198,9 @@ DEF_TAST(cliop_option4_repeat, "test repeat option")
     int nFeed = env.Feed(vecArgs);
     COUT(nFeed == 0, true);
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_vecArgs.size(), 0);
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Argc(), 0);
     COUT(env.Get("a"), "bc");
     COUT(env.Get("advance"), "bc");
 
@@ -206,6 +208,15 @@ DEF_TAST(cliop_option4_repeat, "test repeat option")
     COUT(env.Get("expr", vecExpr), true);
     COUT(vecExpr);
     COUT(vecExpr.size(), 5);
+
+    DESC("Args() has all the repeated values as Get()");
+    COUT(env.Args().at("expr").size(), 9);
+    COUT(env.Args().at("expr") == env.Get("expr"), true);
+
+    const char* argv[] = {"./exe", "-e", "one", "-e", "two", nullptr};
+    COUT(env.Feed(5, argv), 0);
+    COUT(env.Args().at("expr") == std::string("one\0two", 7), true);
+    COUT(env.Args().at("expr") == env.Get("expr"), true);
 }
 
 DEF_TAST(cliop_set1, "test common set option")
@@ -236,7 +247,6 @@ DEF_TAST(cliop_set1, "test common set option")
     int nFeed = env.Feed(vecArgs);
     COUT(nFeed, cli::ERROR_CODE_HELP);
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
 
     env.ClearArgument();
     vecArgs.clear();
@@ -250,7 +260,8 @@ DEF_TAST(cliop_set1, "test common set option")
     util::SplitBySpace(cmdline, vecArgs);
     nFeed = env.Feed(vecArgs);
     COUT(nFeed, 0);
-    COUT(stArgRecv);
+    COUT(env.Args());
+    COUT(env.Argv());
     COUT(env.Has("log.debug"), true);
     COUT(debug, true);
     COUT(env.Get("log.level"), "2");
@@ -268,11 +279,12 @@ DEF_TAST(cliop_set1, "test common set option")
     util::SplitBySpace(cmdline, vecArgs);
     nFeed = env.Feed(vecArgs);
     COUT(nFeed, 0);
-    COUT(stArgRecv);
+    COUT(env.Args());
+    COUT(env.Argv());
     COUT(input, "1.txt");
     COUT(output, "2.txt");
     COUT(user);
-    COUT(stArgRecv.m_vecArgs.size(), 1);
+    COUT(env.Argc(), 1);
 
     DESC("read environment and position argument");
     setenv("USER", "lymslive", 1);
@@ -284,13 +296,14 @@ DEF_TAST(cliop_set1, "test common set option")
     util::SplitBySpace(cmdline, vecArgs);
     nFeed = env.Feed(vecArgs);
     COUT(nFeed, 0);
-    COUT(stArgRecv);
+    COUT(env.Args());
+    COUT(env.Argv());
     COUT(env.Has("input"), true);
     COUT(env.Has("output"), true);
     COUT(input, "11.txt");
     COUT(output, "22.txt");
     COUT(user, "lymslive");
-    COUT(stArgRecv.m_vecArgs.size(), 1);
+    COUT(env.Argc(), 1);
 
     env.ClearArgument();
     vecArgs.clear();
@@ -299,12 +312,13 @@ DEF_TAST(cliop_set1, "test common set option")
     util::SplitBySpace(cmdline, vecArgs);
     nFeed = env.Feed(vecArgs);
     COUT(nFeed, 0);
-    COUT(stArgRecv);
+    COUT(env.Args());
+    COUT(env.Argv());
     COUT(env.Has("input"), true);
     COUT(env.Has("output"), true);
     COUT(input, "111.txt");
     COUT(output, "222.txt");
-    COUT(stArgRecv.m_vecArgs.size(), 1);
+    COUT(env.Argc(), 1);
 
     env.ClearArgument();
     vecArgs.clear();
@@ -313,12 +327,13 @@ DEF_TAST(cliop_set1, "test common set option")
     util::SplitBySpace(cmdline, vecArgs);
     nFeed = env.Feed(vecArgs);
     COUT(nFeed, 0);
-    COUT(stArgRecv);
+    COUT(env.Args());
+    COUT(env.Argv());
     COUT(env.Has("input"), true);
     COUT(env.Has("output"), false);
     COUT(input, "111.txt");
     COUT(output, "222.txt");
-    COUT(stArgRecv.m_vecArgs.size(), 2);
+    COUT(env.Argc(), 2);
 }
 
 // refer to: utest/test-config.ini
@@ -335,7 +350,6 @@ DEF_TAST(cliop_config1, "test read argument from config file")
         .Set("-u $USER --user=", "user name, can read environment")
         .Set("-h --help", "print this help information");
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
 
     std::string cmdline;
     std::vector<std::string> vecArgs;
@@ -351,8 +365,9 @@ DEF_TAST(cliop_config1, "test read argument from config file")
     util::SplitBySpace(cmdline, vecArgs);
     nFeed = env.Feed(vecArgs);
     COUT(nFeed, 0);
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_mapArgs.size());
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Args().size());
 
     COUT(env.Has("config"), true);
     COUT(env.Get("config"), "utest/test-config.ini");
@@ -388,10 +403,10 @@ DEF_TAST(cliop_config1, "test read argument from config file")
     COUT(env.Has("input"), false);
     COUT(env.Has("output"), false);
 
-    COUT(stArgRecv.m_vecArgs.size(), 3);
-    COUT(stArgRecv.m_vecArgs[0], "input.txt");
-    COUT(stArgRecv.m_vecArgs[1], "output.txt");
-    COUT(stArgRecv.m_vecArgs[2], "any-more.txt");
+    COUT(env.Argc(), 3);
+    COUT(env.Argv()[0], "input.txt");
+    COUT(env.Argv()[1], "output.txt");
+    COUT(env.Argv()[2], "any-more.txt");
 
     DESC("cmdline option take precedence over from config");
     env.ClearArgument();
@@ -401,8 +416,9 @@ DEF_TAST(cliop_config1, "test read argument from config file")
     util::SplitBySpace(cmdline, vecArgs);
     nFeed = env.Feed(vecArgs);
     COUT(nFeed, 0);
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_mapArgs.size());
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Args().size());
     COUT(env.Get("group.date"), "NOW");
     COUT(env.Get("group.author"), "YOU");
     COUT(env.Get("user"), "lymslive");
@@ -413,7 +429,6 @@ DEF_TAST(cliop_config2, "test use config as first argument")
     cli::CEnvBase env;
     env.Set("#1 --config=", "config file");
 
-    const cli::CArgument& stArgRecv = env.GetArgument();
 
     std::string cmdline = "utest/test-config.ini --group.author=YOU first.txt";
     std::vector<std::string> vecArgs;
@@ -423,17 +438,18 @@ DEF_TAST(cliop_config2, "test use config as first argument")
     int nFeed = env.Feed(vecArgs);
 
     COUT(nFeed, 0);
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_mapArgs.size());
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Args().size());
     COUT(env.Has("config"), true);
     COUT(env.Get("config"), "utest/test-config.ini");
     COUT(env.Get("group.date"), "now");
     COUT(env.Get("group.author"), "YOU");
-    COUT_ASSERT(stArgRecv.m_vecArgs.size(), 4);
-    COUT(stArgRecv.m_vecArgs[0], "first.txt");
-    COUT(stArgRecv.m_vecArgs[1], "input.txt");
-    COUT(stArgRecv.m_vecArgs[2], "output.txt");
-    COUT(stArgRecv.m_vecArgs[3], "any-more.txt");
+    COUT_ASSERT(env.Argc(), 4);
+    COUT(env.Argv()[0], "first.txt");
+    COUT(env.Argv()[1], "input.txt");
+    COUT(env.Argv()[2], "output.txt");
+    COUT(env.Argv()[3], "any-more.txt");
 }
 
 struct CMyEnv : cli::CEnvBase
@@ -470,6 +486,341 @@ struct CMyEnv : cli::CEnvBase
     }
 };
 
+DEF_TAST(cliop_config3_quote, "test config value quoted and many position lines")
+{
+    const char* pFile = "/tmp/cliop-config3.ini";
+    int nLine = 200000;
+    {
+        std::ofstream fout(pFile);
+        fout << "name = \"  lym slive \"\r\n"
+             << "note='say \"hi\"'\n"
+             << "text = \"a\\tb\\nc\"\n"
+             << "[log]\n"
+             << "--level = 2\n"
+             << "[--]\n"
+             << "\"# not comment\"\n";
+        for (int i = 0; i < nLine; ++i)
+        {
+            fout << "file-" << i << ".txt\n";
+        }
+    }
+
+    cli::CEnvBase env;
+    env.Set("--name=", "user name").Set("--log.level=", "log level");
+    std::string strConfig = std::string("--config=") + pFile;
+    const char* argv[] = {"./exe", strConfig.c_str(), nullptr};
+
+    auto tBegin = std::chrono::steady_clock::now();
+    COUT(env.Feed(2, argv), 0);
+    auto tEnd = std::chrono::steady_clock::now();
+    double fMillisecond = std::chrono::duration<double, std::milli>(tEnd - tBegin).count();
+    COUT(fMillisecond);
+
+    COUT(env.Get("name"), "  lym slive ");
+    COUT(env.Get("note"), "say \"hi\"");
+    COUT(env.Get("text"), "a\tb\nc");
+    COUT(env.Get("log.level"), "2");
+    COUT_ASSERT(env.Argc(), nLine + 1);
+    COUT(env.Get(1), "# not comment");
+    COUT(env.Get(2), "file-0.txt");
+    COUT(env.Get(nLine + 1), "file-" + std::to_string(nLine - 1) + ".txt");
+    remove(pFile);
+}
+
+namespace
+{
+
+/** Write config file with some options and position arguments. */
+void WriteConfig(const char* pFile, const std::string& strName, int nOption, int nArgument)
+{
+    std::ofstream fout(pFile);
+    fout << "name = " << strName << "\n-v\n[group]\n";
+    for (int i = 0; i < nOption; ++i)
+    {
+        fout << "key" << i << " = \"value " << i << "\"\n";
+    }
+    fout << "[--]\n";
+    for (int i = 0; i < nArgument; ++i)
+    {
+        fout << "file-" << i << ".txt\n";
+    }
+}
+
+} // namespace
+
+DEF_TAST(cliop_batch, "test parse many cmdlines in columns")
+{
+    cli::CEnvBase env;
+    env.Set("#1 --input=", "input file").Set("-c --count= [1]", "count")
+        .Set("-e --expr=+", "repeated expression").Set("--user=?", "required user")
+        .Flag('v', "verbose", "print more")
+        .Catch(cli::ERROR_CODE_OPTION_REQUIRED);
+    cli::FErrorHandler fnOld = cli::SetErrorHandler([](int, const std::string&) {});
+
+    std::vector<std::string> vecLines = {
+        "in1.txt -c 3 --user=a file1 file2",
+        "--input='my file' -e x -e \"y z\" --user b -v",
+        "-c 5 in3.txt",
+        "",
+    };
+    cli::CBatchResult stResult;
+    COUT(env.FeedBatch(vecLines, stResult), 4);
+    COUT(stResult.Lines(), 4);
+    cli::SetErrorHandler(fnOld);
+
+    COUT(stResult.Error(0), 0);
+    COUT(stResult.Get(0, "input"), util::CStrView("in1.txt"));
+    COUT(stResult.Get(0, "count"), util::CStrView("3"));
+    COUT(stResult.Get(0, "user"), util::CStrView("a"));
+    COUT(stResult.Has(0, "verbose"), false);
+    COUT(stResult.Argc(0), 2);
+    COUT(stResult.Arg(0, 2), util::CStrView("file2"));
+    COUT(stResult.Arg(0, 3).empty(), true);
+
+    COUT(stResult.Error(1), 0);
+    COUT(stResult.Get(1, "input"), util::CStrView("my file"));
+    COUT(stResult.Get(1, "expr"), util::CStrView("x\0y z", 5));
+    COUT(stResult.Has(1, "v"), true);
+    COUT(stResult.Has(1, "count"), false);
+    COUT(stResult.Get(1, "count"), util::CStrView("1"));
+    COUT(stResult.Argc(1), 0);
+    int nCount = 0;
+    COUT(stResult.Get(0, "count", nCount), true);
+    COUT(nCount, 3);
+    COUT(stResult.Get(0, "user", nCount), false);
+    COUT(nCount, 3);
+
+    DESC("line or option out of range is absent");
+    size_t nLines = stResult.Lines();
+    COUT(stResult.Has(nLines, "input"), false);
+    COUT(stResult.Get(nLines, "input").empty(), true);
+    COUT(stResult.Get(0, 1000).empty(), true);
+    COUT(stResult.Argc(nLines), 0);
+    COUT(stResult.Arg(nLines, 1).empty(), true);
+    COUT(stResult.Error(nLines), -1);
+
+    DESC("line missing required option has error but still saved");
+    COUT(stResult.Error(2), cli::ERROR_CODE_OPTION_REQUIRED);
+    COUT(stResult.Get(2, "input"), util::CStrView("in3.txt"));
+    COUT(stResult.Error(3), cli::ERROR_CODE_OPTION_REQUIRED);
+
+    DESC("append lines from reader of job file");
+    const char* pFile = "/tmp/cliop-batch.txt";
+    {
+        std::ofstream fout(pFile);
+        fout << "a.txt --user=x\nb.txt --user=y -c 9\n";
+    }
+    util::CLineReader stReader(pFile);
+    COUT(env.FeedBatch([&stReader](util::CStrView& strLine) { return stReader.Next(strLine); }, stResult), 2);
+    COUT(stResult.Lines(), 6);
+    COUT(stResult.Get(5, "count"), util::CStrView("9"));
+    COUT(stResult.Get(1, "input"), util::CStrView("my file"));
+    remove(pFile);
+}
+
+DEF_TAST(cliop_config4_cache, "test parsed config cached in binary file")
+{
+    const char* pFile = "/tmp/cliop-config4.ini";
+    const char* pCache = "/tmp/cliop-config4.cache";
+    remove(pCache);
+    WriteConfig(pFile, "lym", 10, 5);
+
+    cli::CEnvBase env;
+    env.Set("--name=", "user name").Flag('v', "verbose", "print more")
+        .ConfigCache(pCache).Catch(cli::ERROR_CODE_CONFIG_UNREADABLE);
+    std::string strConfig = std::string("--config=") + pFile;
+    const char* argv[] = {"./exe", strConfig.c_str(), nullptr};
+
+    COUT(env.Feed(2, argv), 0);
+    COUT(env.Get("name"), "lym");
+    COUT(env.Has("verbose"), true);
+    COUT(env.Get("group.key9"), "value 9");
+    COUT(env.Argc(), 5);
+    struct stat stStat;
+    COUT(stat(pCache, &stStat), 0);
+
+    DESC("same size and mtime use the cache");
+    COUT(stat(pFile, &stStat), 0);
+    WriteConfig(pFile, "you", 10, 5);
+    struct timespec aTime[2] = {stStat.st_atim, stStat.st_mtim};
+    COUT(utimensat(AT_FDCWD, pFile, aTime, 0), 0);
+    COUT(env.Feed(2, argv), 0);
+    COUT(env.Get("name"), "lym");
+    COUT(env.Has("verbose"), true);
+    COUT(env.Get("group.key0"), "value 0");
+    COUT(env.Argc(), 5);
+    COUT(env.Get(5), "file-4.txt");
+
+    DESC("changed config parsed again");
+    WriteConfig(pFile, "they", 3, 2);
+    COUT(env.Feed(2, argv), 0);
+    COUT(env.Get("name"), "they");
+    COUT(env.Get("group.key9"), "");
+    COUT(env.Argc(), 2);
+    COUT(env.Feed(2, argv), 0);
+    COUT(env.Get("name"), "they");
+
+    DESC("absent config found by stat");
+    remove(pFile);
+    COUT(env.Feed(2, argv), cli::ERROR_CODE_CONFIG_UNREADABLE);
+    remove(pCache);
+}
+
+DEF_TAST(cliop_config5_reload, "test reload config and re-bind changed options")
+{
+    const char* pFile = "/tmp/cliop-config5.ini";
+    {
+        std::ofstream fout(pFile);
+        fout << "threads = 4\ntimeout = 30\nhost = a.com\nlevel = info\n";
+    }
+
+    int threads = 0;
+    int timeout = 0;
+    std::string host;
+    std::vector<int> ports;
+    cli::CEnvBase env;
+    env.Set("--threads=", "thread count", threads)
+        .Set("--timeout=", "timeout second", timeout)
+        .Set("--host=", "host name", host)
+        .Set("--port=+", "port list", ports)
+        .Set("--level=", "log level");
+    std::string strConfig = std::string("--config=") + pFile;
+    const char* argv[] = {"./exe", strConfig.c_str(), "--host=cmd.com", nullptr};
+    COUT(env.Feed(3, argv), 0);
+    COUT(threads, 4);
+    COUT(host, "cmd.com");
+
+    std::vector<std::string> vecChanged;
+    int fdWatch = env.WatchConfig([&vecChanged](const std::vector<std::string>& vecName)
+    {
+        vecChanged = vecName;
+    });
+    COUT(fdWatch >= 0, true);
+    COUT(env.CheckConfig(), 0);
+    COUT(vecChanged.empty(), true);
+
+    DESC("changed file is detected, cmdline option keep precedence");
+    {
+        std::ofstream fout(pFile);
+        fout << "threads = 8\ntimeout = 30\nhost = b.com\nport=80\nport=81\n";
+    }
+    threads = -1;
+    timeout = -1;
+    COUT(env.CheckConfig(), 0);
+    COUT(vecChanged);
+    COUT(vecChanged.size(), 3);
+    COUT(threads, 8);
+    COUT(timeout, -1);
+    COUT(host, "cmd.com");
+    COUT(ports.size(), 2);
+    COUT(env.Get("level"), "");
+    COUT(env.Get<int>("threads"), 8);
+
+    DESC("SIGHUP trigger reload even without file event");
+    int threads2 = 0;
+    cli::CEnvBase env2;
+    env2.Set("--threads=", "thread count", threads2);
+    const char* argv2[] = {"./exe", strConfig.c_str(), nullptr};
+    COUT(env2.Feed(2, argv2), 0);
+    COUT(threads2, 8);
+    {
+        std::ofstream fout(pFile);
+        fout << "threads = 2\n";
+    }
+    vecChanged.clear();
+    env2.WatchConfig([&vecChanged](const std::vector<std::string>& vecName)
+    {
+        vecChanged = vecName;
+    });
+    COUT(env2.CheckConfig(), 0);
+    COUT(threads2, 8);
+    raise(SIGHUP);
+    COUT(env2.CheckConfig(), 0);
+    COUT(threads2, 2);
+    COUT_ASSERT(vecChanged.size(), 1);
+    COUT(vecChanged[0], "threads");
+
+    DESC("removed option is reset to default or zero value");
+    {
+        std::ofstream fout(pFile);
+        fout << "name=alice\nport=8080\nmode=fast\n";
+    }
+    std::string name;
+    int port = 0;
+    std::string mode;
+    cli::CEnvBase env3;
+    env3.Set("--name=", "user name", name)
+        .Set("--port=", "port number", port)
+        .Set("--mode= [slow]", "has default", mode)
+        .Catch(cli::ERROR_CODE_ARGTYPE_UNMATCH);
+    const char* argv3[] = {"./exe", strConfig.c_str(), "file", nullptr};
+    COUT(env3.Feed(3, argv3), 0);
+    COUT(name, "alice");
+    COUT(port, 8080);
+    COUT(mode, "fast");
+    {
+        std::ofstream fout(pFile);
+    }
+    COUT(env3.ReloadConfig(), 0);
+    COUT(name, "");
+    COUT(port, 0);
+    COUT(mode, "slow");
+    COUT(env3.Get("name"), "");
+    COUT(env3.Get(1), "file");
+
+    DESC("bad value in reload changes nothing");
+    {
+        std::ofstream fout(pFile);
+        fout << "name=bob\nport=abc\n";
+    }
+    COUT(env3.ReloadConfig(), cli::ERROR_CODE_ARGTYPE_UNMATCH);
+    env3.ClearError();
+    COUT(name, "");
+    COUT(port, 0);
+    COUT(env3.Get("name"), "");
+    COUT(env3.Has("port"), false);
+
+    DESC("repeated reload does not grow the received buffer");
+    size_t nBuffer = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        {
+            std::ofstream fout(pFile);
+            fout << (i % 2 == 0 ? "name=carol\nport=1\n" : "name=david\nport=2\n");
+        }
+        if (env3.ReloadConfig() != 0)
+        {
+            break;
+        }
+        if (i == 0)
+        {
+            nBuffer = env3.GetArgument().m_strBuffer.size();
+        }
+    }
+    COUT(name, "david");
+    COUT(port, 2);
+    COUT(env3.GetArgument().m_strBuffer.size(), nBuffer);
+    COUT(env3.Get(1), "file");
+
+    DESC("option bound by short name is also re-bound");
+    {
+        std::ofstream fout(pFile);
+        fout << "number=1\n";
+    }
+    int number = 0;
+    cli::CEnvBase env4;
+    env4.Set("-n --number=", "the number").Bind("n", number);
+    COUT(env4.Feed(2, argv2), 0);
+    COUT(number, 1);
+    {
+        std::ofstream fout(pFile);
+        fout << "number=2\n";
+    }
+    COUT(env4.ReloadConfig(), 0);
+    COUT(number, 2);
+    remove(pFile);
+}
+
 DEF_TAST(cliop_bindst1, "test bind struct field")
 {
     CMyEnv env;
@@ -478,10 +829,10 @@ DEF_TAST(cliop_bindst1, "test bind struct field")
     std::vector<std::string> vecArgs;
     util::SplitBySpace(cmdline, vecArgs);
     int nFeed = env.Feed(vecArgs);
-    const cli::CArgument& stArgRecv = env.GetArgument();
     COUT(nFeed, 0);
-    COUT(stArgRecv);
-    COUT(stArgRecv.m_vecArgs.size(), 3);
+    COUT(env.Args());
+    COUT(env.Argv());
+    COUT(env.Argc(), 3);
 
     COUT(env.debug, true);
     COUT(env.count, 2);
@@ -509,3 +860,614 @@ DEF_TAST(cliop_bindst1, "test bind struct field")
         COUT(nFeed, 11);
     }
 }
+
+DEF_TAST(cliop_option5_scale, "test lookup per option not grow with option count")
+{
+    uint64_t nFixedLookup = 0;
+    for (int nOption = 10; nOption <= 10000; nOption *= 10)
+    {
+        std::vector<std::string> vecNames(nOption);
+        std::vector<std::string> vecArgs(nOption);
+        for (int i = 0; i < nOption; ++i)
+        {
+            vecNames[i] = "option.name." + std::to_string(i);
+            vecArgs[i] = "--" + vecNames[i] + "=" + std::to_string(i);
+        }
+
+        cli::CEnvBase env;
+        env.SetOptionOnly().Set("--config= [NONE]", "not load config");
+        for (int i = 0; i < nOption; ++i)
+        {
+            env.Option('\0', vecNames[i], "generated option");
+        }
+        env.EnableStats();
+        COUT(nOption);
+        COUT(env.Feed(vecArgs), 0);
+        COUT(env.Has(vecNames.back()), true);
+        COUT(env.Stats()->m_nToken, (uint64_t)nOption);
+        // one lookup per token, and a fixed count for reserved options
+        uint64_t nExtra = env.Stats()->m_nLookup - nOption;
+        if (nOption == 10)
+        {
+            nFixedLookup = nExtra;
+        }
+        COUT(nExtra, nFixedLookup);
+
+        DESC("hash index compare names about once for each find");
+        cli::CNameIndex stIndex;
+        int nCompare = 0;
+        auto fnName = [&vecNames, &nCompare](int id) -> const std::string& { nCompare++; return vecNames[id]; };
+        for (int i = 0; i < nOption; ++i)
+        {
+            stIndex.Insert(vecNames[i].data(), vecNames[i].size(), i, fnName);
+        }
+        nCompare = 0;
+        int nFound = 0;
+        for (int i = 0; i < nOption; ++i)
+        {
+            nFound += stIndex.Find(vecNames[i].data(), vecNames[i].size(), fnName) == i ? 1 : 0;
+        }
+        COUT(nFound, nOption);
+        COUT(nCompare <= nOption + nOption / 100, true);
+    }
+}
+
+DEF_TAST(cliop_feed3_view, "test feed argv without copy")
+{
+    int argc = 6;
+    const char* argv[] = {"./exe", "--name=water", "-c", "2", "-pfoo", "file1", nullptr};
+
+    cli::CEnvBase env;
+    env.Set("-c --count=", "count").Set("-p --prefix=", "prefix");
+    COUT(env.Feed(argc, argv), 0);
+
+    DESC("saved argument refer to argv memory");
+    const cli::CArgument& stArgRecv = env.GetArgument();
+    COUT(stArgRecv.GetUnknown("name")->m_pExtern == argv[1] + 7, true);
+    COUT(stArgRecv.GetOption(env.OptionId("count"))->m_pExtern == argv[3], true);
+    COUT(stArgRecv.GetOption(env.OptionId("prefix"))->m_pExtern == argv[4] + 2, true);
+    COUT(stArgRecv.m_vecArgs[0].m_pExtern == argv[5], true);
+    COUT(stArgRecv.m_strBuffer.empty(), true);
+
+    DESC("materialize string when get");
+    COUT(env.Get("name"), "water");
+    COUT(env.Get("c"), "2");
+    COUT(env.Get("prefix"), "foo");
+    COUT(env.Get(1), "file1");
+    COUT(env.Argc(), 1);
+    COUT(env.Argv().size(), 1);
+    COUT(env.Args().size(), 3);
+    COUT(env.Args().at("name"), "water");
+
+    DESC("undeclared short flags in cluster are copied");
+    {
+        const char* argv[] = {"./exe", "-ab", "-c", "file", nullptr};
+        cli::CEnvBase env;
+        env.Set("--config= [NONE]", "no config");
+        COUT(env.Feed(4, argv), 0);
+        COUT(env.Has("a"), true);
+        COUT(env.Has("b"), true);
+        COUT(env.Has("c"), true);
+        COUT(env.Args());
+        COUT(env.Args().size(), 3);
+        COUT(env.Args().count("a"), 1);
+        COUT(env.Get(1), "file");
+    }
+}
+
+DEF_TAST(cliop_feed4_reuse, "test received argument keep capacity in repeated feed")
+{
+    std::vector<std::string> vecArgs = {"--name=water", "-c", "2", "--extra=1", "file1", "file2"};
+
+    cli::CEnvBase env;
+    env.Set("-c --count=", "count").Set("--name=", "name").Set("--config= [NONE]", "no config");
+    COUT(env.Feed(vecArgs), 0);
+    COUT(env.Get("name"), "water");
+    COUT(env.Get("extra"), "1");
+
+    const cli::CArgument& stArgRecv = env.GetArgument();
+    COUT(stArgRecv.m_strBuffer.empty(), false);
+    const char* pBuffer = stArgRecv.m_strBuffer.data();
+    const cli::CArgValue* pValue = stArgRecv.m_vecValue.data();
+    const cli::CArgValue* pArgs = stArgRecv.m_vecArgs.data();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        env.ClearArgument();
+        COUT(env.Has("name"), false);
+        COUT(env.Feed(vecArgs), 0);
+    }
+
+    DESC("no reallocation after the first feed");
+    COUT(stArgRecv.m_strBuffer.data() == pBuffer, true);
+    COUT(stArgRecv.m_vecValue.data() == pValue, true);
+    COUT(stArgRecv.m_vecArgs.data() == pArgs, true);
+    COUT(env.Get("name"), "water");
+    COUT(env.Get("count"), "2");
+    COUT(env.Get("extra"), "1");
+    COUT(env.Get(2), "file2");
+}
+
+DEF_TAST(cliop_feed5_response, "test expand response file in cmdline")
+{
+    const char* pFile1 = "/tmp/cliop-response-1.txt";
+    const char* pFile2 = "/tmp/cliop-response-2.txt";
+    const char* pFile3 = "/tmp/cliop-response-3.txt";
+    {
+        std::ofstream fout(pFile1);
+        fout << "-c 3 --name \"a b\"\n@" << pFile2 << "\nfile1\n";
+    }
+    {
+        std::ofstream fout(pFile2);
+        fout << "--extra=2 file2 --name";
+    }
+    {
+        std::ofstream fout(pFile3);
+        fout << "x @" << pFile3;
+    }
+
+    cli::CEnvBase env;
+    env.Set("-c --count=", "count").Set("--name=", "name").Set("--config= [NONE]", "no config");
+    env.ResponseFile();
+    std::string strArg1 = std::string("@") + pFile1;
+    const char* argv[] = {"resp", strArg1.c_str(), "file3", nullptr};
+    COUT(env.Feed(3, argv), 0);
+    COUT(env.Get("count"), "3");
+    COUT(env.Get("name"), "a b");
+    COUT(env.Get("extra"), "2");
+    COUT(env.Argc(), 2);
+    COUT(env.Get(1), "file2");
+    DESC("the last option in response file take the next argument");
+    COUT(env.Get(2), "file3");
+
+    DESC("missing file and after -- are normal argument");
+    const char* argvMiss[] = {"resp", "@/tmp/cliop-not-exist.txt", "--", strArg1.c_str(), nullptr};
+    COUT(env.Feed(4, argvMiss), 0);
+    COUT(env.Argc(), 2);
+    COUT(env.Get(1), "@/tmp/cliop-not-exist.txt");
+    COUT(env.Get(2), strArg1);
+
+    DESC("recursive response file stop at max depth");
+    std::string strArg3 = std::string("@") + pFile3;
+    const char* argvDeep[] = {"resp", strArg3.c_str(), nullptr};
+    COUT(env.Feed(2, argvDeep), 0);
+    COUT(env.Argc(), 9);
+    COUT(env.Get(9), strArg3);
+    env.Catch(cli::ERROR_CODE_RESPONSE_DEPTH);
+    COUT(env.Feed(2, argvDeep), cli::ERROR_CODE_RESPONSE_DEPTH);
+    env.ClearError();
+
+    DESC("disabled by default");
+    cli::CEnvBase env2;
+    env2.Set("--config= [NONE]", "no config");
+    COUT(env2.Feed(3, argv), 0);
+    COUT(env2.Get(1), strArg1);
+
+    remove(pFile1);
+    remove(pFile2);
+    remove(pFile3);
+}
+
+DEF_TAST(cliop_feed6_stream, "test feed arguments streamed from source")
+{
+    cli::CEnvBase env;
+    env.Set("-c --count=", "count").Set("--config= [NONE]", "no config");
+
+    DESC("generator of arguments");
+    int nNext = 0;
+    std::vector<std::string> vecArgs = {"-c", "5", "a1", "a2"};
+    COUT(env.Feed([&](util::CStrView& strArg)
+    {
+        if (nNext >= (int)vecArgs.size())
+        {
+            return false;
+        }
+        strArg = vecArgs[nNext++];
+        return true;
+    }), 0);
+    COUT(env.Get("count"), "5");
+    COUT(env.Argc(), 2);
+
+    DESC("more arguments than ARG_MAX from pipe");
+    int nFile = 200000;
+    int fdPipe[2];
+    COUT(pipe(fdPipe), 0);
+    std::thread thWriter([fdPipe, nFile]()
+    {
+        std::string strChunk = "--count 7\n";
+        for (int i = 0; i < nFile; ++i)
+        {
+            strChunk.append("/some/long/path/to/input-file-").append(std::to_string(i)).append(".txt\n");
+            if (strChunk.size() > 4096 || i + 1 == nFile)
+            {
+                size_t nWrite = 0;
+                while (nWrite < strChunk.size())
+                {
+                    ssize_t nOnce = write(fdPipe[1], strChunk.data() + nWrite, strChunk.size() - nWrite);
+                    if (nOnce <= 0)
+                    {
+                        break;
+                    }
+                    nWrite += nOnce;
+                }
+                strChunk.clear();
+            }
+        }
+        close(fdPipe[1]);
+    });
+    auto tBegin = std::chrono::steady_clock::now();
+    int nRet = env.Feed(cli::StreamSource(fdPipe[0]));
+    auto tEnd = std::chrono::steady_clock::now();
+    thWriter.join();
+    close(fdPipe[0]);
+    COUT(nRet, 0);
+    COUT(env.Get("count"), "7");
+    COUT(env.Argc(), nFile);
+    COUT(env.Get(nFile), "/some/long/path/to/input-file-" + std::to_string(nFile - 1) + ".txt");
+    COUT(env.GetArgument().m_strBuffer.size() > (size_t)sysconf(_SC_ARG_MAX), true);
+    double fStreamMs = std::chrono::duration<double, std::milli>(tEnd - tBegin).count();
+    COUT(fStreamMs);
+}
+
+DEF_TAST(cliop_feed7_argument_stream, "test position argument passed to callback")
+{
+    std::vector<std::string> vecReceived;
+    cli::CEnvBase env;
+    env.Set("#1 --input=", "input file").Set("#2 --output=", "output file")
+        .Set("-c --count=", "count").Set("--config= [NONE]", "no config")
+        .StreamArgument([&vecReceived](const util::CStrView& strArg) { vecReceived.push_back(strArg.ToString()); });
+
+    const char* argv[] = {"stream", "in.txt", "-c", "2", "out.txt", "a1", "--", "a2", nullptr};
+    COUT(env.Feed(8, argv), 0);
+    COUT(env.Get("input"), "in.txt");
+    COUT(env.Get("output"), "out.txt");
+    COUT(env.Get("count"), "2");
+    COUT(env.Argc(), 0);
+    COUT(vecReceived.size(), 2);
+    COUT(vecReceived[0], "a1");
+    COUT(vecReceived[1], "a2");
+
+    DESC("explicit bound option stop moving");
+    vecReceived.clear();
+    const char* argvExplicit[] = {"stream", "--input=x", "a1", "a2", nullptr};
+    COUT(env.Feed(4, argvExplicit), 0);
+    COUT(env.Get("input"), "x");
+    COUT(env.Has("output"), false);
+    COUT(vecReceived.size(), 2);
+
+    DESC("memory stays constant for many arguments");
+    int nFile = 1000000;
+    int nNext = 0;
+    size_t nLength = 0;
+    std::string strFile;
+    env.StreamArgument([&nLength](const util::CStrView& strArg) { nLength += strArg.size(); });
+    int nRet = env.Feed([&](util::CStrView& strArg)
+    {
+        if (nNext >= nFile)
+        {
+            return false;
+        }
+        strFile = "file-" + std::to_string(nNext++);
+        strArg = strFile;
+        return true;
+    });
+    COUT(nRet, 0);
+    COUT(env.Get("output"), "file-1");
+    COUT(nLength > (size_t)nFile * 6, true);
+    COUT(env.GetArgument().m_vecArgs.capacity() < 16, true);
+    COUT(env.GetArgument().m_strBuffer.size() < 64, true);
+}
+
+DEF_TAST(cliop_option6_repeat_list, "test repeated option saved as list")
+{
+    const int nRepeat = 1000;
+    std::vector<std::string> vecStore;
+    for (int i = 0; i < nRepeat; ++i)
+    {
+        vecStore.push_back("-e" + std::to_string(i));
+    }
+    std::vector<const char*> argv;
+    argv.push_back("./exe");
+    for (auto& item : vecStore)
+    {
+        argv.push_back(item.c_str());
+    }
+    argv.push_back(nullptr);
+
+    std::vector<int> vecExpr;
+    cli::CEnvBase env;
+    env.Set("-e --expr=+", "repeated expression", vecExpr).Set("--config= [NONE]", "no config");
+    COUT(env.Feed(argv.size() - 1, &argv[0]), 0);
+
+    DESC("each value refer to argv, no joined copy");
+    const cli::CArgument& stArgRecv = env.GetArgument();
+    COUT(stArgRecv.m_strBuffer.empty(), true);
+    int iOption = env.OptionId("expr");
+    COUT(stArgRecv.m_vecOption[iOption].m_nCount, nRepeat);
+    const cli::CArgValue* pValue = stArgRecv.GetOption(iOption);
+    COUT(pValue->m_pExtern == argv[1] + 2, true);
+    pValue = stArgRecv.Next(pValue);
+    COUT(pValue->m_pExtern == argv[2] + 2, true);
+
+    DESC("bound list converted from each value");
+    COUT_ASSERT(vecExpr.size(), nRepeat);
+    COUT(vecExpr[0], 0);
+    COUT(vecExpr[nRepeat-1], nRepeat-1);
+
+    std::vector<std::string> vecStr;
+    COUT(env.Get("e", vecStr), true);
+    COUT(vecStr.size(), nRepeat);
+    COUT(vecStr[1], "1");
+
+    DESC("raw string still joined by null");
+    std::string strJoin = env.Get("expr");
+    COUT(strJoin.substr(0, 4) == std::string("0\0" "1", 3) + '\0', true);
+}
+
+DEF_TAST(cliop_option7_delimiter, "test list option split by delimiter")
+{
+    std::vector<int> vecId;
+    std::vector<double> vecRate;
+    std::vector<std::string> vecTag;
+    cli::CEnvBase env;
+    env.Set("-i --ids=+", "id list").Set("--rate=", "rate list").Set("-t --tag=+", "tag list")
+        .Bind("ids", vecId, ',').Bind("rate", vecRate, ',').Bind("tag", vecTag, ':');
+
+    const char* argv[] = {"./exe", "--ids=1,2,3", "-i", "40,0x32,", "--rate=0.5,1e2",
+        "-t", "a:b", "-t", "c", "--config=NONE", nullptr};
+    COUT(env.Feed(10, argv), 0);
+    COUT(vecId);
+    COUT(vecId.size(), 5);
+    COUT(vecId[4], 50);
+    COUT(vecRate.size(), 2);
+    COUT(vecRate[1], 100.0);
+    COUT(vecTag);
+    COUT(vecTag.size(), 3);
+
+    std::vector<int> vecGet;
+    COUT(env.Get("ids", vecGet, ','), true);
+    COUT(vecGet == vecId, true);
+    std::vector<std::string> vecStr;
+    COUT(env.Get("ids", vecStr), true);
+    COUT(vecStr.size(), 2);
+
+    DESC("invalid item reject the whole list");
+    std::vector<int> vecBad = {9};
+    cli::CEnvBase env2;
+    env2.Set("--ids=+", "id list").Bind("ids", vecBad, ',').Catch(cli::ERROR_CODE_ARGTYPE_UNMATCH);
+    const char* argvBad[] = {"./exe", "--ids=1,2", "--ids=3,x", "--config=NONE", nullptr};
+    COUT(env2.Feed(4, argvBad), cli::ERROR_CODE_ARGTYPE_UNMATCH);
+    COUT(vecBad.size(), 1);
+
+    DESC("but get list skip only invalid item");
+    cli::CEnvBase env3;
+    env3.Set("--list=", "number list").Set("-n --number=+", "repeated number");
+    const char* argvSkip[] = {"./exe", "--list=1,x,3", "-n", "4", "-n", "y", "-n", "6.5", "--config=NONE", nullptr};
+    COUT(env3.Feed(9, argvSkip), 0);
+    std::vector<int> vecList;
+    COUT(env3.Get("list", vecList, ','), true);
+    COUT(vecList);
+    COUT(vecList.size(), 2);
+    COUT(vecList[1], 3);
+    std::vector<double> vecNumber;
+    COUT(env3.Get("number", vecNumber, '\0'), true);
+    COUT(vecNumber.size(), 2);
+    COUT(vecNumber[1], 6.5);
+}
+
+DEF_TAST(cliop_get_cached, "test typed get converted once per feed")
+{
+    cli::CEnvBase env;
+    env.Set("-n --number= [4]", "thread number")
+        .Set("--timeout= $CLIOP_TEST_TIMEOUT", "timeout in second")
+        .Set("-e --expr=+", "repeated expression")
+        .Flag('v', "verbose", "print more");
+    setenv("CLIOP_TEST_TIMEOUT", "2.5", 1);
+
+    const char* argv[] = {"./exe", "-v", "-e", "1", "-e", "2", "--config=NONE", nullptr};
+    COUT(env.Feed(7, argv), 0);
+    COUT(env.Get<int>("number"), 4);
+    COUT(env.Get<double>("timeout"), 2.5);
+    COUT(env.Get<bool>("verbose"), true);
+    COUT(env.Get<std::vector<int>>("expr").size(), 2);
+    COUT(env.Get<std::string>("number"), "4");
+    COUT(env.Get<int>("unknown"), 0);
+
+    DESC("the same reference before next feed");
+    const int& iNumber = env.Get<int>("number");
+    COUT(&iNumber == &env.Get<int>("number"), true);
+    setenv("CLIOP_TEST_TIMEOUT", "9", 1);
+    COUT(env.Get<double>("timeout"), 2.5);
+
+    DESC("convert again after feed");
+    const char* argv2[] = {"./exe", "-n", "8", "-e", "3", "--config=NONE", nullptr};
+    COUT(env.Feed(6, argv2), 0);
+    COUT(iNumber, 4);
+    COUT(env.Get<int>("number"), 8);
+    COUT(iNumber, 8);
+    COUT(env.Get<double>("timeout"), 9.0);
+    COUT(env.Get<bool>("verbose"), false);
+    COUT(env.Get<std::vector<int>>("expr").size(), 1);
+    unsetenv("CLIOP_TEST_TIMEOUT");
+
+    DESC("cached typed get does not allocate");
+    const std::vector<int>& vecExpr = env.Get<std::vector<int>>("expr");
+    bench::CAllocScope scope;
+    int iSum = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        iSum += env.Get<int>("number") + env.Get<std::vector<int>>("expr").size();
+    }
+    COUT(scope.Count(), 0);
+    COUT(iSum, 9 * 100);
+    COUT(&vecExpr == &env.Get<std::vector<int>>("expr"), true);
+
+    DESC("invalid or overflow number is not got");
+    {
+        cli::CEnvBase env;
+        env.Set("-n --number=", "thread number").Set("--big=", "big number")
+            .Catch(cli::ERROR_CODE_ARGTYPE_UNMATCH);
+        const char* argv[] = {"./exe", "-n", "12abc", "--big=99999999999", "--config=NONE", nullptr};
+        COUT(env.Feed(5, argv), 0);
+        int iNumber = 7;
+        COUT(env.Get("number", iNumber), false);
+        COUT(iNumber, 7);
+        COUT(env.HasError(), true);
+        env.ClearError();
+        COUT(env.Get<int>("number"), 0);
+        COUT(env.HasError(), true);
+        env.ClearError();
+        int iBig = 7;
+        COUT(env.Get("big", iBig), false);
+        COUT(iBig, 7);
+        COUT(env.HasError(), false);
+        int64_t lBig = 0;
+        COUT(env.Get("big", lBig), true);
+        COUT(lBig, 99999999999);
+    }
+}
+
+DEF_TAST(cliop_env_snapshot, "test environment read in one pass when feed")
+{
+    setenv("CLIOP_TEST_HOST", "localhost", 1);
+    setenv("CLIOP_APP_LOG_LEVEL", "debug", 1);
+    setenv("CLIOP_APP_MAX_CONN", "64", 1);
+    setenv("CLIOP_APP_PORT", "8080", 1);
+    setenv("CLIOP_APP_EXTRA_NAME", "extra", 1);
+
+    int port = 0;
+    cli::CEnvBase env;
+    env.Set("--host= $CLIOP_TEST_HOST [127.0.0.1]", "host name")
+        .Set("--port= $CLIOP_TEST_PORT [80]", "port number", port)
+        .Set("--log.level= [info]", "log level")
+        .Set("--max_conn= [16]", "max connection")
+        .EnvPrefix("CLIOP_APP_");
+
+    const char* argv[] = {"./exe", "--config=NONE", nullptr};
+    COUT(env.Feed(2, argv), 0);
+    COUT(env.Get("host"), "localhost");
+    COUT(env.GetDefault("host"), "localhost");
+    COUT(env.Get("log.level"), "debug");
+    COUT(env.Get("max_conn"), "64");
+    COUT(env.Get("extra.name"), "extra");
+    COUT(env.Has("log.level"), false);
+
+    DESC("prefix import also for option bound to other name");
+    COUT(port, 8080);
+    setenv("CLIOP_TEST_PORT", "9090", 1);
+    COUT(env.Feed(2, argv), 0);
+    COUT(port, 9090);
+
+    DESC("setenv after feed does not change the snapshot");
+    setenv("CLIOP_TEST_HOST", "remote", 1);
+    COUT(env.Get("host"), "localhost");
+
+    DESC("cmdline argument has priority");
+    const char* argv2[] = {"./exe", "--log.level=warn", "--host=other", "--config=NONE", nullptr};
+    COUT(env.Feed(4, argv2), 0);
+    COUT(env.Get("log.level"), "warn");
+    COUT(env.Get("host"), "other");
+
+    DESC("without prefix only bound name is read");
+    cli::CEnvBase env2;
+    env2.Set("--host= $CLIOP_TEST_HOST", "host name").Set("--log.level= [info]", "log level");
+    COUT(env2.Feed(2, argv), 0);
+    COUT(env2.Get("host"), "remote");
+    COUT(env2.Get("log.level"), "info");
+    COUT(env2.Get("extra.name"), "");
+
+    unsetenv("CLIOP_TEST_HOST");
+    unsetenv("CLIOP_TEST_PORT");
+    unsetenv("CLIOP_APP_LOG_LEVEL");
+    unsetenv("CLIOP_APP_MAX_CONN");
+    unsetenv("CLIOP_APP_PORT");
+    unsetenv("CLIOP_APP_EXTRA_NAME");
+}
+
+DEF_TAST(cliop_freeze, "test freeze option setup before feed")
+{
+    std::string input;
+    std::string output;
+    cli::CEnvBase env;
+    env.Set("-i #1 --input=", "input file", input)
+        .Set("-o #2 --output=", "output file", output)
+        .Set("--config= [NONE]", "no config");
+
+    DESC("reserved option added when freeze");
+    COUT(env.OptionId("help"), -1);
+    env.Freeze();
+    COUT(env.OptionId("help") >= 0, true);
+    COUT(env.OptionId("version") >= 0, true);
+
+    int argc = 4;
+    const char* argv[] = {"./exe", "1.txt", "2.txt", "3.txt", nullptr};
+    COUT(env.Feed(argc, argv), 0);
+    COUT(input, "1.txt");
+    COUT(output, "2.txt");
+    COUT(env.Argc(), 1);
+
+    DESC("add option after freeze is still effective");
+    env.Set("-r --required=?", "required option");
+    COUT(env.Feed(argc, argv), cli::ERROR_CODE_OPTION_REQUIRED);
+
+    const char* argv2[] = {"./exe", "-rR", "1.txt", "2.txt", nullptr};
+    env.ClearError();
+    COUT(env.Feed(argc, argv2), 0);
+    COUT(env.Get("required"), "R");
+
+    DESC("position bind error checked in freeze");
+    cli::CEnvBase env2;
+    env2.Catch(cli::ERROR_CODE_POSITION_BIND).Set("#2 --output=", "output file");
+    env2.Freeze();
+    COUT(env2.HasError(), true);
+}
+
+DEF_TAST(cliop_stats, "test parse statistics of each phase")
+{
+    int level = 0;
+    cli::CEnvBase env;
+    env.Set("--log.level=", "log level", level)
+        .Set("-u --user=", "user name")
+        .Set("-abc", "some flags");
+    COUT(env.Stats() == nullptr, true);
+
+    DESC("no stats and reserved option when disabled");
+    const char* argv[] = {"./exe", "-u", "me", "--config=utest/test-config.ini", "in.txt", nullptr};
+    COUT(env.Feed(5, argv), 0);
+    COUT(env.OptionId("cliop-stats"), -1);
+
+    DESC("enable after freeze still add the reserved option");
+    env.EnableStats();
+    COUT(env.OptionId("cliop-stats") >= 0, true);
+    COUT(env.Feed(5, argv), 0);
+    const cli::CParseStats* pStats = env.Stats();
+    COUT(pStats->m_nFeed, 1);
+    COUT(pStats->m_nToken >= 4, true);
+    COUT(pStats->m_nConfigLine > 20, true);
+    COUT(pStats->m_nLookup > 0, true);
+    COUT(pStats->m_nCopyBytes > 0, true);
+    COUT(pStats->m_aPhaseNs[cli::PARSE_PHASE_CONFIG] > 0, true);
+    COUT(pStats->m_aPhaseNs[cli::PARSE_PHASE_CMDLINE] > 0, true);
+    COUT(level, 2);
+
+    std::string text;
+    pStats->Format(text);
+    COUT(text);
+    COUT(text.find("time.config:") != std::string::npos, true);
+    COUT(text.find("config.line:") != std::string::npos, true);
+
+    DESC("count summed until clear, argv not copied");
+    env.Stats()->Clear();
+    const char* argvNone[] = {"./exe", "-u", "me", "--config=NONE", "--cliop-stats", nullptr};
+    COUT(env.Feed(5, argvNone), 0);
+    COUT(env.Feed(5, argvNone), 0);
+    COUT(pStats->m_nFeed, 2);
+    COUT(pStats->m_nToken, 8);
+    COUT(pStats->m_nConfigLine, 0);
+    COUT(pStats->m_nCopyBytes, 0);
+
+    DESC("disable drop the stats");
+    env.EnableStats(false);
+    COUT(env.Stats() == nullptr, true);
+    COUT(env.Feed(5, argvNone), 0);
+}
@@ -1,5 +1,6 @@
 #include "tinytast.hpp"
 #include "cliop.h"
+#include <limits.h>
 
 DEF_TAST(error_setoption, "error in preset option")
 {
@@ -366,13 +367,15 @@ DEF_TAST(error_bind, "test unmatch bound type of argument")
         int argc = 2;
         const char* argv[] = {"./exe", "--int=+1", nullptr};
         env.ClearError();
-        COUT(env.Feed(argc, argv), cli::ERROR_CODE_ARGTYPE_UNMATCH);
+        COUT(env.Feed(argc, argv), 0);
+        COUT(iArg, 1);
     }
     {
         int argc = 2;
         const char* argv[] = {"./exe", "--int=0x01abcdef", nullptr};
         env.ClearError();
-        COUT(env.Feed(argc, argv), cli::ERROR_CODE_ARGTYPE_UNMATCH);
+        COUT(env.Feed(argc, argv), 0);
+        COUT(iArg, 0x01abcdef);
     }
     {
         int argc = 3;
@@ -390,7 +393,8 @@ DEF_TAST(error_bind, "test unmatch bound type of argument")
         int argc = 2;
         const char* argv[] = {"./exe", "--float=3.14e2", nullptr};
         env.ClearError();
-        COUT(env.Feed(argc, argv), cli::ERROR_CODE_ARGTYPE_UNMATCH);
+        COUT(env.Feed(argc, argv), 0);
+        COUT(fArg, 314.0, 0.001);
     }
     {
         int argc = 3;
@@ -402,7 +406,7 @@ DEF_TAST(error_bind, "test unmatch bound type of argument")
         int argc = 3;
         const char* argv[] = {"./exe", "--Float=1.0.1", "--Float=1.0", nullptr};
         env.ClearError();
-        COUT(env.Feed(argc, argv), 0);
+        COUT(env.Feed(argc, argv), cli::ERROR_CODE_ARGTYPE_UNMATCH);
     }
     {
         int argc = 3;
@@ -412,6 +416,60 @@ DEF_TAST(error_bind, "test unmatch bound type of argument")
     }
 }
 
+DEF_TAST(error_bind_overflow, "test bound number out of range")
+{
+    int iArg = 0;
+    int64_t lArg = 0;
+    uint64_t uArg = 0;
+    float fArg = 0;
+
+    cli::CEnvBase env;
+    env.Catch(cli::ERROR_CODE_ARGTYPE_UNMATCH)
+        .Set("--int=", "scalar int", iArg)
+        .Set("--long=", "scalar int64", lArg)
+        .Set("--ulong=", "scalar uint64", uArg)
+        .Set("--float=", "scalar float", fArg);
+
+    {
+        const char* argv[] = {"./exe", "--int=-2147483648", "--long=-9223372036854775808",
+            "--ulong=0xFFFFFFFFFFFFFFFF", "--float=1.5e3", nullptr};
+        COUT(env.Feed(5, argv), 0);
+        COUT(iArg, INT_MIN);
+        COUT(lArg, INT64_MIN);
+        COUT(uArg, UINT64_MAX);
+        COUT(fArg, 1500.0f, 0.001);
+    }
+
+    DESC("overflow is clamped if not catch");
+    {
+        const char* argv[] = {"./exe", "--int=2147483648", nullptr};
+        COUT(env.Feed(2, argv), 0);
+        COUT(iArg, INT_MAX);
+    }
+
+    env.Catch(cli::ERROR_CODE_ARGUMENT_OVERFLOW);
+    {
+        const char* argv[] = {"./exe", "--long=9223372036854775808", nullptr};
+        COUT(env.Feed(2, argv), cli::ERROR_CODE_ARGUMENT_OVERFLOW);
+        env.ClearError();
+    }
+    {
+        const char* argv[] = {"./exe", "--ulong=18446744073709551616", nullptr};
+        COUT(env.Feed(2, argv), cli::ERROR_CODE_ARGUMENT_OVERFLOW);
+        env.ClearError();
+    }
+    {
+        const char* argv[] = {"./exe", "--float=1e39", nullptr};
+        COUT(env.Feed(2, argv), cli::ERROR_CODE_ARGUMENT_OVERFLOW);
+        env.ClearError();
+    }
+    {
+        const char* argv[] = {"./exe", "--ulong=-1", nullptr};
+        COUT(env.Feed(2, argv), cli::ERROR_CODE_ARGTYPE_UNMATCH);
+        env.ClearError();
+    }
+}
+
 static int s_myError = 0;
 void my_error_report(int code, const std::string& text)
 {
@@ -0,0 +1,129 @@
+#include "tinytast.hpp"
+#include "cliop-server.h"
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+
+namespace
+{
+
+/** Command served in other thread, no COUT in handlers. */
+std::unique_ptr<cli::CEnvBase> ServerCommand()
+{
+    std::unique_ptr<cli::CEnvBase> pEnv(new cli::CEnvBase());
+    pEnv->Command("math", "basic operation")
+        .SubCommand("add", "as operator+", [](int, const char*[], cli::CEnvBase* args)
+        {
+            int sum = atoi(args->Get(1).c_str()) + atoi(args->Get(2).c_str());
+            printf("sum=%d\n", sum);
+            return sum;
+        })
+        .SubCommand("echo", "print arguments", [](int argc, const char* argv[], cli::CEnvBase*)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                fprintf(stderr, "%s;", argv[i]);
+            }
+            return argc - 1;
+        });
+    return pEnv;
+}
+
+/** Read all that was written to the pipe, close both ends. */
+std::string ReadPipe(int aPipe[2])
+{
+    close(aPipe[1]);
+    std::string strOutput;
+    char aBuffer[256];
+    ssize_t nRead = 0;
+    while ((nRead = read(aPipe[0], aBuffer, sizeof(aBuffer))) > 0)
+    {
+        strOutput.append(aBuffer, nRead);
+    }
+    close(aPipe[0]);
+    return strOutput;
+}
+
+} // namespace
+
+DEF_TAST(server_call, "test call command in server by unix socket")
+{
+    std::string strPath = "/tmp/cliop-test-" + std::to_string(getpid()) + ".sock";
+    cli::CCommandServer server(ServerCommand);
+    server.SetTimeout(100);
+    COUT(server.Listen(strPath), 0);
+    COUT(access(strPath.c_str(), F_OK), 0);
+    std::thread thServer([&server]() { server.Serve(); });
+
+    DESC("./math add 2 3, output to pipe");
+    {
+        int aPipe[2];
+        COUT(pipe(aPipe), 0);
+        const char* argv[] = {"./math", "add", "2", "3", "--config=NONE", nullptr};
+        COUT(cli::CallServer(strPath, 5, argv, 0, aPipe[1], 2), 5);
+        COUT(ReadPipe(aPipe), std::string("sum=5\n"));
+    }
+
+    DESC("./math echo a b c, error output to pipe");
+    {
+        int aPipe[2];
+        COUT(pipe(aPipe), 0);
+        const char* argv[] = {"./math", "echo", "a", "b", "c", nullptr};
+        COUT(cli::CallServer(strPath, 5, argv, 0, 1, aPipe[1]), 3);
+        COUT(ReadPipe(aPipe), std::string("a;b;c;"));
+    }
+
+    DESC("each request has fresh result");
+    {
+        int aPipe[2];
+        COUT(pipe(aPipe), 0);
+        const char* argv[] = {"./math", "add", "10", "--config=NONE", nullptr};
+        COUT(cli::CallServer(strPath, 4, argv, 0, aPipe[1], 2), 10);
+        COUT(ReadPipe(aPipe), std::string("sum=10\n"));
+    }
+
+    DESC("./math --help");
+    {
+        int aPipe[2];
+        COUT(pipe(aPipe), 0);
+        const char* argv[] = {"./math", "--help", nullptr};
+        COUT(cli::CallServer(strPath, 2, argv, 0, aPipe[1], 2), cli::ERROR_CODE_HELP);
+        std::string strHelp = ReadPipe(aPipe);
+        COUT(strHelp.find("add") != std::string::npos, true);
+        COUT(strHelp.find("echo") != std::string::npos, true);
+    }
+
+    DESC("half-sent request is dropped, not block the next call");
+    {
+        struct sockaddr_un stAddr;
+        memset(&stAddr, 0, sizeof(stAddr));
+        stAddr.sun_family = AF_UNIX;
+        strncpy(stAddr.sun_path, strPath.c_str(), sizeof(stAddr.sun_path) - 1);
+        int fdSilent = socket(AF_UNIX, SOCK_STREAM, 0);
+        COUT(connect(fdSilent, reinterpret_cast<struct sockaddr*>(&stAddr), sizeof(stAddr)), 0);
+        int fdHalf = socket(AF_UNIX, SOCK_STREAM, 0);
+        COUT(connect(fdHalf, reinterpret_cast<struct sockaddr*>(&stAddr), sizeof(stAddr)), 0);
+        COUT(write(fdHalf, "\x10\0", 2), 2);
+
+        int aPipe[2];
+        COUT(pipe(aPipe), 0);
+        const char* argv[] = {"./math", "add", "1", "2", "--config=NONE", nullptr};
+        COUT(cli::CallServer(strPath, 5, argv, 0, aPipe[1], 2), 3);
+        COUT(ReadPipe(aPipe), std::string("sum=3\n"));
+        close(fdSilent);
+        close(fdHalf);
+    }
+
+    server.Stop();
+    thServer.join();
+    COUT(server.Served(), 5);
+    server.Close();
+    COUT(access(strPath.c_str(), F_OK), -1);
+
+    DESC("no server to call");
+    const char* argv[] = {"./math", "add", "2", "3", nullptr};
+    COUT(cli::CallServer(strPath, 4, argv), -1);
+    COUT(cli::CallServer(std::string(200, 'x'), 4, argv), -1);
+    COUT(cli::CallServer(strPath, 0, argv), -1);
+}
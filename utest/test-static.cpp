@@ -0,0 +1,122 @@
+#include "tinytast.hpp"
+#include "cliop-static.h"
+#include "alloc-hook.h"
+
+namespace
+{
+
+struct CMainOption
+{
+    static constexpr cli::COptionDecl value[] = {
+        {'v', "verbose", "print more message", "", 0},
+        {'n', "number", "how many times", "1"},
+        {'e', "expr", "repeated expression", "", cli::OPTION_ARGUMENT | cli::OPTION_REPEATED},
+        {'\0', "user", "required user name", "", cli::OPTION_ARGUMENT | cli::OPTION_REQUIRED},
+        {'\0', "log.level", "log level", "info"},
+    };
+};
+constexpr cli::COptionDecl CMainOption::value[];
+
+#define DECL_OPTION(i) {'\0', "option.name." #i, "generated option"}
+#define DECL_OPTION8(i) DECL_OPTION(i##0), DECL_OPTION(i##1), DECL_OPTION(i##2), DECL_OPTION(i##3), \
+    DECL_OPTION(i##4), DECL_OPTION(i##5), DECL_OPTION(i##6), DECL_OPTION(i##7)
+
+struct CManyOption
+{
+    static constexpr cli::COptionDecl value[] = {
+        DECL_OPTION8(1), DECL_OPTION8(2), DECL_OPTION8(3), DECL_OPTION8(4),
+        DECL_OPTION8(5), DECL_OPTION8(6), DECL_OPTION8(7), DECL_OPTION8(8),
+    };
+};
+constexpr cli::COptionDecl CManyOption::value[];
+
+} // namespace
+
+DEF_TAST(static_spec, "test option table declared at compile time")
+{
+    const cli::CPerfectIndex& stIndex = cli::StaticSpec<CMainOption>();
+    COUT(stIndex.m_nDecl, 5);
+    COUT(stIndex.m_uMask + 1 >= stIndex.m_nDecl, true);
+    for (size_t i = 0; i < stIndex.m_nDecl; ++i)
+    {
+        const char* pName = stIndex.m_pDecl[i].m_pLongName;
+        COUT(stIndex.Find(pName, strlen(pName)), (int)i);
+    }
+    COUT(stIndex.Find("verb", 4), -1);
+    COUT(stIndex.Find("verbose2", 8), -1);
+    COUT(stIndex.Find("", 0), -1);
+
+    const cli::CPerfectIndex& stMany = cli::StaticSpec<CManyOption>();
+    COUT(stMany.m_nDecl, 64);
+    int nFound = 0;
+    for (size_t i = 0; i < stMany.m_nDecl; ++i)
+    {
+        const char* pName = stMany.m_pDecl[i].m_pLongName;
+        nFound += stMany.Find(pName, strlen(pName)) == (int)i ? 1 : 0;
+    }
+    COUT(nFound, 64);
+}
+
+DEF_TAST(static_declare, "test declared options feed into env")
+{
+    int number = 0;
+    std::vector<std::string> expr;
+    cli::CEnvBase env;
+    env.Declare(cli::StaticSpec<CMainOption>())
+        .Bind("number", number)
+        .Bind("expr", expr)
+        .Catch(cli::ERROR_CODE_OPTION_REQUIRED);
+    COUT(env.OptionId("log.level"), 4);
+
+    const char* argv[] = {"static", "-v", "-n", "3", "-e", "a", "-e", "b", "--user=me", "--config=NONE", nullptr};
+    COUT(env.Feed(10, argv), 0);
+    COUT(env.Has("verbose"), true);
+    COUT(number, 3);
+    COUT(expr.size(), 2);
+    COUT(env.Get("user"), std::string("me"));
+    COUT(env.Get("log.level"), std::string("info"));
+    COUT(env.Has("help"), false);
+
+    const char* argvLess[] = {"static", "--config=NONE", nullptr};
+    COUT(env.Feed(2, argvLess), cli::ERROR_CODE_OPTION_REQUIRED);
+
+    DESC("declare after other option just add each one");
+    cli::CEnvBase env2;
+    env2.Option('x', "extra", "extra option").Declare(cli::StaticSpec<CMainOption>());
+    COUT(env2.OptionId("extra"), 0);
+    COUT(env2.OptionId("number"), 2);
+    const char* argv2[] = {"static", "-x", "1", "-n", "2", "--user=me", "--config=NONE", nullptr};
+    COUT(env2.Feed(7, argv2), 0);
+    COUT(env2.Get("number"), std::string("2"));
+}
+
+DEF_TAST(static_startup, "test declared option setup allocate less than runtime setup")
+{
+    const char* argv[] = {"static", "--option.name.42=42", "--config=NONE", nullptr};
+    const cli::CPerfectIndex& stMany = cli::StaticSpec<CManyOption>();
+
+    bench::CAllocScope scope;
+    {
+        cli::CEnvBase env;
+        for (size_t k = 0; k < stMany.m_nDecl; ++k)
+        {
+            env.Option('\0', stMany.m_pDecl[k].m_pLongName, stMany.m_pDecl[k].m_pDescription);
+        }
+        COUT(env.Feed(3, argv), 0);
+        COUT(env.Get("option.name.42"), std::string("42"));
+    }
+    uint64_t nRuntime = scope.Count();
+
+    scope.Reset();
+    {
+        cli::CEnvBase env;
+        env.Declare(stMany);
+        COUT(env.Feed(3, argv), 0);
+        COUT(env.Get("option.name.42"), std::string("42"));
+    }
+    uint64_t nDeclare = scope.Count();
+    COUT(nRuntime);
+    COUT(nDeclare);
+    COUT(nDeclare < nRuntime, true);
+    // see static_declare of bench-cliop for the startup time
+}
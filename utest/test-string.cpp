@@ -1,6 +1,12 @@
 #include "tinytast.hpp"
 #include "util-string.h"
 #include "test-os.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <cmath>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
 
 DEF_TAST(string_split, "test split string")
 {
@@ -154,3 +160,249 @@ DEF_TAST(string_align1, "test align text with 2 col")
     std::string text = align.GetText();
     fprintf(stderr, "%s\n", text.c_str());
 }
+
+DEF_TAST(string_view, "test light string view")
+{
+    std::string str = "--key=val";
+    util::CStrView view(str);
+    COUT(view.size(), str.size());
+    COUT(view.data() == str.data(), true);
+    COUT(view == "--key=val", true);
+    COUT(view != "--key", true);
+
+    size_t iEqual = view.find('=');
+    COUT(iEqual, 5);
+    COUT(view.find('=', iEqual + 1) == util::CStrView::npos, true);
+    COUT(view.substr(2, iEqual - 2).ToString(), "key");
+    COUT(view.substr(iEqual + 1).ToString(), "val");
+    COUT(view.substr(iEqual + 1).data() == str.data() + iEqual + 1, true);
+    COUT(view.substr(100).empty(), true);
+
+    util::CStrView empty;
+    COUT(empty.empty(), true);
+    COUT(empty == "", true);
+}
+
+DEF_TAST(string_number, "test parse number from string")
+{
+    int iVal = 0;
+    COUT(util::ParseNumber("123", iVal), util::NUMBER_OK);
+    COUT(iVal, 123);
+    COUT(util::ParseNumber("+5", iVal), util::NUMBER_OK);
+    COUT(iVal, 5);
+    COUT(util::ParseNumber("-0x1F", iVal), util::NUMBER_OK);
+    COUT(iVal, -31);
+    COUT(util::ParseNumber("010", iVal), util::NUMBER_OK);
+    COUT(iVal, 10);
+    COUT(util::ParseNumber("", iVal), util::NUMBER_INVALID);
+    COUT(util::ParseNumber("-", iVal), util::NUMBER_INVALID);
+    COUT(util::ParseNumber("0x", iVal), util::NUMBER_INVALID);
+    COUT(util::ParseNumber("12abc", iVal), util::NUMBER_INVALID);
+    COUT(util::ParseNumber(" 12", iVal), util::NUMBER_INVALID);
+    COUT(iVal, 10);
+    COUT(util::ParseNumber("2147483648", iVal), util::NUMBER_OVERFLOW);
+    COUT(iVal, INT_MAX);
+
+    int64_t lVal = 0;
+    COUT(util::ParseNumber("-9223372036854775808", lVal), util::NUMBER_OK);
+    COUT(lVal, INT64_MIN);
+    COUT(util::ParseNumber("9223372036854775808", lVal), util::NUMBER_OVERFLOW);
+    COUT(lVal, INT64_MAX);
+
+    uint64_t uVal = 0;
+    COUT(util::ParseNumber("18446744073709551615", uVal), util::NUMBER_OK);
+    COUT(uVal, UINT64_MAX);
+    COUT(util::ParseNumber("18446744073709551616", uVal), util::NUMBER_OVERFLOW);
+    COUT(util::ParseNumber("-1", uVal), util::NUMBER_INVALID);
+
+    double fVal = 0;
+    COUT(util::ParseNumber("1e3", fVal), util::NUMBER_OK);
+    COUT(fVal, 1000.0);
+    COUT(util::ParseNumber("-.5", fVal), util::NUMBER_OK);
+    COUT(fVal, -0.5);
+    COUT(util::ParseNumber("3.", fVal), util::NUMBER_OK);
+    COUT(fVal, 3.0);
+    COUT(util::ParseNumber("0.1", fVal), util::NUMBER_OK);
+    COUT(fVal == 0.1, true);
+    COUT(util::ParseNumber("1.7976931348623157e308", fVal), util::NUMBER_OK);
+    COUT(fVal == 1.7976931348623157e308, true);
+    COUT(util::ParseNumber("12345678901234567890123", fVal), util::NUMBER_OK);
+    COUT(fVal == 12345678901234567890123.0, true);
+    COUT(util::ParseNumber("4.9e-324", fVal), util::NUMBER_OK);
+    COUT(fVal == 4.9e-324, true);
+    COUT(util::ParseNumber("1e400", fVal), util::NUMBER_OVERFLOW);
+    COUT(util::ParseNumber("-INF", fVal), util::NUMBER_OK);
+    COUT(fVal < 0 && std::isinf(fVal), true);
+    COUT(util::ParseNumber("nan", fVal), util::NUMBER_OK);
+    COUT(fVal != fVal, true);
+    COUT(util::ParseNumber(".", fVal), util::NUMBER_INVALID);
+    COUT(util::ParseNumber("1e", fVal), util::NUMBER_INVALID);
+    COUT(util::ParseNumber("1.0.1", fVal), util::NUMBER_INVALID);
+    COUT(util::ParseNumber("1,5", fVal), util::NUMBER_INVALID);
+
+    float fFloat = 0;
+    COUT(util::ParseNumber("1.5", fFloat), util::NUMBER_OK);
+    COUT(fFloat, 1.5f);
+    COUT(util::ParseNumber("1e39", fFloat), util::NUMBER_OVERFLOW);
+}
+
+DEF_TAST(string_split_number, "test split string to number list")
+{
+    COUT(util::CountChar("", ','), 0);
+    COUT(util::CountChar("1,2,3", ','), 2);
+    COUT(util::CountChar("a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p,q", ','), 16);
+
+    std::vector<int> vecInt;
+    COUT(util::SplitNumber("1,2,33,-4", vecInt, ','), 0);
+    COUT(vecInt);
+    COUT(util::SplitNumber("5,0x10,", vecInt, ','), 0);
+    COUT(vecInt.size(), 6);
+    COUT(vecInt[5], 16);
+
+    DESC("invalid item restore the original size");
+    COUT(util::SplitNumber("7,x,8", vecInt, ','), util::NUMBER_INVALID);
+    COUT(vecInt.size(), 6);
+    COUT(util::SplitNumber("7,,8", vecInt, ','), util::NUMBER_INVALID);
+    COUT(util::SplitNumber("7,99999999999", vecInt, ','), util::NUMBER_OVERFLOW);
+    COUT(vecInt.size(), 6);
+    COUT(util::SplitNumber("", vecInt, ','), 0);
+    COUT(vecInt.size(), 6);
+
+    std::vector<double> vecDouble;
+    COUT(util::SplitNumber("0.5;1e3;-2", vecDouble, ';'), 0);
+    COUT(vecDouble);
+
+    std::vector<int64_t> vecLong;
+    COUT(util::SplitNumber("9223372036854775807,1", vecLong, ','), 0);
+    COUT(vecLong[0] == INT64_MAX, true);
+
+    DESC("large list of ids");
+    std::string strIds;
+    int nId = 200000;
+    for (int i = 0; i < nId; ++i)
+    {
+        strIds += std::to_string(i);
+        strIds += ',';
+    }
+    COUT(util::CountChar(strIds, ','), nId);
+    vecInt.clear();
+    COUT(util::SplitNumber(strIds, vecInt, ','), 0);
+    COUT(vecInt.size(), nId);
+    int nMismatch = 0;
+    for (int i = 0; i < nId; ++i)
+    {
+        nMismatch += vecInt[i] == i ? 0 : 1;
+    }
+    COUT(nMismatch, 0);
+}
+
+DEF_TAST(string_line_reader, "test read file line by line as view")
+{
+    COUT(util::TrimView("  a b \t"), util::CStrView("a b"));
+    COUT(util::TrimView("   ").empty(), true);
+
+    std::string strBuffer;
+    COUT(util::Unquote("abc", strBuffer), util::CStrView("abc"));
+    COUT(util::Unquote("\" a b \"", strBuffer), util::CStrView(" a b "));
+    COUT(util::Unquote("'a\\nb'", strBuffer), util::CStrView("a\\nb"));
+    COUT(util::Unquote("\"a\\nb\\\"c\\\\d\\x\"", strBuffer), util::CStrView("a\nb\"c\\d\\x"));
+    COUT(util::Unquote("\"", strBuffer), util::CStrView("\""));
+    COUT(util::Unquote("\"a'", strBuffer), util::CStrView("\"a'"));
+
+    const char* pFile = "/tmp/cliop-line-reader.txt";
+    {
+        std::ofstream fout(pFile);
+        fout << "first\n\n  third  \r\nlast";
+    }
+    util::CLineReader stReader;
+    COUT(stReader.Open(pFile), true);
+    std::vector<std::string> vecLine;
+    util::CStrView strLine;
+    while (stReader.Next(strLine))
+    {
+        vecLine.push_back(strLine.ToString());
+    }
+    COUT(vecLine.size(), 4);
+    COUT(vecLine[1].empty(), true);
+    COUT(vecLine[2], "  third  ");
+    COUT(vecLine[3], "last");
+
+    DESC("empty file has no line, missing file cannot open");
+    {
+        std::ofstream fout(pFile);
+    }
+    COUT(stReader.Open(pFile), true);
+    COUT(stReader.Next(strLine), false);
+    COUT(stReader.Open("/tmp/cliop-not-exist.txt"), false);
+    COUT(stReader.IsOpen(), false);
+    COUT(stReader.Open("/tmp"), false);
+    remove(pFile);
+}
+
+DEF_TAST(string_token_reader, "test read whitespace separated tokens in chunks")
+{
+    const char* pFile = "/tmp/cliop-token-reader.txt";
+    {
+        std::ofstream fout(pFile);
+        fout << "  first\tsecond\n\n\"a b\" --name='x y'z \"c\\nd\"\r\nlast";
+    }
+    util::CTokenReader stReader;
+    COUT(stReader.Open(pFile), true);
+    std::vector<std::string> vecToken;
+    util::CStrView strToken;
+    while (stReader.Next(strToken))
+    {
+        vecToken.push_back(strToken.ToString());
+    }
+    COUT(vecToken.size(), 6);
+    COUT(vecToken[1], "second");
+    COUT(vecToken[2], "a b");
+    COUT(vecToken[3], "--name=x yz");
+    COUT(vecToken[4], "c\nd");
+    COUT(vecToken[5], "last");
+
+    DESC("token cross the chunk boundary");
+    int nToken = 20000;
+    {
+        std::ofstream fout(pFile);
+        for (int i = 0; i < nToken; ++i)
+        {
+            fout << "file-" << i << ".txt" << (i % 7 == 0 ? "\n" : " ");
+        }
+    }
+    int nMatch = 0;
+    int nRead = 0;
+    COUT(stReader.Open(pFile), true);
+    while (stReader.Next(strToken))
+    {
+        nMatch += strToken == ("file-" + std::to_string(nRead) + ".txt") ? 1 : 0;
+        nRead++;
+    }
+    COUT(nRead, nToken);
+    COUT(nMatch, nToken);
+
+    DESC("read from attached fd, not closed by reader");
+    int fd = open(pFile, O_RDONLY);
+    stReader.Attach(fd);
+    COUT(stReader.Next(strToken), true);
+    COUT(strToken, util::CStrView("file-0.txt"));
+    stReader.Close();
+    COUT(close(fd), 0);
+
+    COUT(stReader.Open("/tmp/cliop-not-exist.txt"), false);
+    COUT(stReader.Open("/tmp"), false);
+    remove(pFile);
+
+    DESC("split token from string in memory");
+    util::CStrView strLine = " -c 3 --name=\"a b\" 'x' ";
+    std::string strBuffer;
+    size_t iPos = 0;
+    std::vector<std::string> vecLine;
+    while (util::NextToken(strLine, iPos, strToken, strBuffer))
+    {
+        vecLine.push_back(strToken.ToString());
+    }
+    COUT(vecLine.size(), 4);
+    COUT(vecLine[2], "--name=a b");
+    COUT(vecLine[3], "x");
+}
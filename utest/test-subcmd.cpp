@@ -1,5 +1,6 @@
 #include "tinytast.hpp"
 #include "cliop.h"
+#include <dlfcn.h>
 
 namespace math
 {
@@ -171,3 +172,202 @@ DEF_TAST(subcmd_invalid, "test invalid sub commmand")
         COUT(env.Feed(argc, argv), cli::ERROR_CODE_COMMAND_UNKNOWN);
     }
 }
+
+DEF_TAST(subcmd_multicall, "test sub commmand dispatch by argv[0] of symlink")
+{
+    cli::CEnvBase env;
+    env.Command("box", "multi-call binary");
+    env.Set("--config= [NONE]", "no config");
+    std::string strCalled;
+    for (int i = 0; i < 400; ++i)
+    {
+        std::string strName = "cmd" + std::to_string(i);
+        env.SubCommand(strName, "generated sub-command",
+                [&strCalled, strName](int argc, const char*[], cli::CEnvBase*)
+                { strCalled = strName; return argc; });
+    }
+    env.SubCommand("cmd7", "redefined, the first one take effect",
+            [](int, const char*[], cli::CEnvBase*) { return -1; });
+
+    DESC("./box cmd123 x");
+    {
+        const char* argv[] = {"./box", "cmd123", "x", nullptr};
+        COUT(env.Feed(3, argv), 2);
+        COUT(strCalled, std::string("cmd123"));
+    }
+
+    DESC("/usr/bin/cmd399 x");
+    {
+        const char* argv[] = {"/usr/bin/cmd399", "x", nullptr};
+        COUT(env.Feed(2, argv), 2);
+        COUT(strCalled, std::string("cmd399"));
+    }
+
+    DESC("cmd7 x");
+    {
+        const char* argv[] = {"cmd7", "x", nullptr};
+        COUT(env.Feed(2, argv), 2);
+        COUT(strCalled, std::string("cmd7"));
+    }
+
+    DESC("/usr/bin/box cmd4000");
+    {
+        strCalled.clear();
+        const char* argv[] = {"/usr/bin/box", "cmd4000", nullptr};
+        COUT(env.Feed(2, argv), 0);
+        COUT(strCalled.empty(), true);
+    }
+}
+
+namespace math
+{
+
+/** Count the created sub-command object. */
+struct CLazyMul : public CMul
+{
+    static int s_nCreated;
+    CLazyMul() { s_nCreated++; }
+};
+int CLazyMul::s_nCreated = 0;
+
+} // math
+
+DEF_TAST(subcmd_lazy, "test sub commmand object created when dispatched")
+{
+    math::CLazyMul::s_nCreated = 0;
+    int nAdd = 0;
+    cli::CEnvBase env;
+    env.Command("math", "basic operation")
+        .SubCommand<math::CLazyMul>("mul", "as operator*")
+        .SubCommand("add", "as operator+", [&nAdd]()
+        {
+            nAdd++;
+            return std::unique_ptr<cli::CEnvBase>(new math::CAdd());
+        });
+    COUT(math::CLazyMul::s_nCreated, 0);
+
+    DESC("./math --help");
+    {
+        const char* argv[] = {"./math", "--help", nullptr};
+        COUT(env.Feed(2, argv), cli::ERROR_CODE_HELP);
+        COUT(math::CLazyMul::s_nCreated, 0);
+        COUT(nAdd, 0);
+    }
+
+    DESC("./math add --left=2 --right=3");
+    {
+        const char* argv[] = {"./math", "add", "--left=2", "--right=3", nullptr};
+        COUT(env.Feed(4, argv), 5);
+        COUT(nAdd, 1);
+        COUT(math::CLazyMul::s_nCreated, 0);
+    }
+
+    DESC("./math mul --help");
+    {
+        const char* argv[] = {"./math", "mul", "--help", nullptr};
+        COUT(env.Feed(3, argv), cli::ERROR_CODE_HELP);
+        COUT(math::CLazyMul::s_nCreated, 1);
+    }
+
+    DESC("./math mul --left=2 --right=3, reuse the created one");
+    {
+        const char* argv[] = {"./math", "mul", "--left=2", "--right=3", nullptr};
+        COUT(env.Feed(4, argv), 6);
+        COUT(math::CLazyMul::s_nCreated, 1);
+    }
+}
+
+DEF_TAST(subcmd_plugin, "test sub commmand loaded from shared object")
+{
+    COUT(CLIOP_TEST_PLUGIN);
+    cli::CEnvBase env;
+    env.Catch(cli::ERROR_CODE_PLUGIN_LOAD);
+    env.Command("math", "basic operation")
+        .SubCommand("add", "as operator+", math::add)
+        .PluginCommand("sub", "as operator-", CLIOP_TEST_PLUGIN)
+        .PluginCommand("none", "entry return null", CLIOP_TEST_PLUGIN, "plugin_null_command")
+        .PluginCommand("nosym", "entry not found", CLIOP_TEST_PLUGIN, "no_such_entry")
+        .PluginCommand("nofile", "plugin not found", "no-such-plugin.so");
+
+    DESC("./math add 2 3, plugin not loaded");
+    {
+        const char* argv[] = {"./math", "add", "2", "3", nullptr};
+        COUT(env.Feed(4, argv), 5);
+        COUT(dlopen(CLIOP_TEST_PLUGIN, RTLD_NOW | RTLD_NOLOAD) == nullptr, true);
+    }
+
+    DESC("./math sub 5 3");
+    {
+        const char* argv[] = {"./math", "sub", "5", "3", nullptr};
+        COUT(env.Feed(4, argv), 2);
+        void* pHandle = dlopen(CLIOP_TEST_PLUGIN, RTLD_NOW | RTLD_NOLOAD);
+        COUT(pHandle != nullptr, true);
+        dlclose(pHandle);
+    }
+
+    DESC("./math sub --left=9 --right=3");
+    {
+        const char* argv[] = {"./math", "sub", "--left=9", "--right=3", nullptr};
+        COUT(env.Feed(4, argv), 6);
+    }
+
+    DESC("./math sub --help");
+    {
+        const char* argv[] = {"./math", "sub", "--help", nullptr};
+        COUT(env.Feed(3, argv), cli::ERROR_CODE_HELP);
+    }
+
+    DESC("entry not found or plugin not found");
+    {
+        const char* argv[] = {"./math", "nosym", nullptr};
+        COUT(env.Feed(2, argv), cli::ERROR_CODE_PLUGIN_LOAD);
+        env.ClearError();
+        const char* argv2[] = {"./math", "nofile", nullptr};
+        COUT(env.Feed(2, argv2), cli::ERROR_CODE_PLUGIN_LOAD);
+        env.ClearError();
+    }
+
+    DESC("entry return null, fail to dispatch");
+    {
+        const char* argv[] = {"./math", "none", "--config=NONE", nullptr};
+        COUT(env.Feed(3, argv), cli::ERROR_CODE_PLUGIN_LOAD);
+        env.ClearError();
+    }
+
+    DESC("not caught, still fail without running main command");
+    {
+        int nMain = 0;
+        cli::CEnvBase env;
+        env.Command("math", "basic operation", [&nMain](int, const char*[], cli::CEnvBase*)
+            {
+                nMain++;
+                return 0;
+            })
+            .PluginCommand("nofile", "plugin not found", "no-such-plugin.so")
+            .PluginCommand("nosym", "entry not found", CLIOP_TEST_PLUGIN, "no_such_entry")
+            .SubCommand("null", "factory return null", []() { return std::unique_ptr<cli::CEnvBase>(); });
+        const char* argv[] = {"./math", "nofile", "--config=NONE", nullptr};
+        COUT(env.Feed(3, argv), cli::ERROR_CODE_PLUGIN_LOAD);
+        const char* argv2[] = {"./math", "nosym", "--config=NONE", nullptr};
+        COUT(env.Feed(3, argv2), cli::ERROR_CODE_PLUGIN_LOAD);
+        const char* argv3[] = {"./math", "null", "--config=NONE", nullptr};
+        COUT(env.Feed(3, argv3), cli::ERROR_CODE_PLUGIN_LOAD);
+        COUT(env.HasError(), false);
+        COUT(nMain, 0);
+        const char* argv4[] = {"./math", "--config=NONE", nullptr};
+        COUT(env.Feed(2, argv4), 0);
+        COUT(nMain, 1);
+
+        DESC("dl error is consumed even not caught, and reported when caught");
+        std::string strText;
+        cli::FErrorHandler fnOld = cli::SetErrorHandler([&strText](int, const std::string& text) { strText = text; });
+        env.Ignore(cli::ERROR_CODE_PLUGIN_LOAD);
+        env.Feed(3, argv);
+        COUT(dlerror() == nullptr, true);
+        env.Catch(cli::ERROR_CODE_PLUGIN_LOAD);
+        COUT(env.Feed(3, argv2), cli::ERROR_CODE_PLUGIN_LOAD);
+        COUT(strText);
+        COUT(strText.find("no_such_entry") != std::string::npos, true);
+        cli::SetErrorHandler(fnOld);
+    }
+}
@@ -0,0 +1,260 @@
+#include "tinytast.hpp"
+#include "cliop.h"
+#include "alloc-hook.h"
+#include <thread>
+#include <atomic>
+
+namespace
+{
+
+/** Build a spec for concurrent parsing, without bound variable. */
+std::shared_ptr<const cli::CEnvSpec> ThreadSpec(cli::CEnvBase& env)
+{
+    env.Flag('v', "verbose", "print more")
+        .Option('n', "number", "the number of thread", "1")
+        .Set("-e --expr=+", "repeated expression")
+        .Set("#1 --input=", "input file")
+        .Catch(cli::ERROR_CODE_OPTION_REQUIRED);
+    env.Set("--user=?", "required user name");
+    return env.Share();
+}
+
+/** Feed a cmdline that is different for each thread and round.
+ * @return int: count of mismatch values.
+ * */
+int FeedOnce(cli::CParseContext& ctx, int iThread, int iRound)
+{
+    std::string strNumber = std::to_string(iThread * 1000 + iRound);
+    std::string strExpr = "e" + std::to_string(iRound);
+    std::string strUser = "--user=u" + std::to_string(iThread);
+    const char* argv[] = {"thread", "in.txt", "-v", "-n", strNumber.c_str(),
+        "-e", strExpr.c_str(), "-e", "last", strUser.c_str(), "--config=NONE", nullptr};
+    int argc = sizeof(argv) / sizeof(argv[0]) - 1;
+
+    int nMismatch = 0;
+    if (ctx.Feed(argc, argv) != 0)
+    {
+        return 1;
+    }
+    nMismatch += ctx.Has("verbose") ? 0 : 1;
+    nMismatch += ctx.Get("number") == strNumber ? 0 : 1;
+    nMismatch += ctx.Get("input") == "in.txt" ? 0 : 1;
+    nMismatch += ctx.Get("user") == strUser.substr(7) ? 0 : 1;
+    std::vector<std::string> vecExpr;
+    ctx.Get("expr", vecExpr);
+    nMismatch += (vecExpr.size() == 2 && vecExpr[0] == strExpr && vecExpr[1] == "last") ? 0 : 1;
+    return nMismatch;
+}
+
+/** Run `nRound` feeds in each of `nThread` threads, return total mismatch. */
+int RunThreads(std::shared_ptr<const cli::CEnvSpec> pSpec, int nThread, int nRound)
+{
+    std::atomic<int> nMismatch(0);
+    std::vector<std::thread> vecThread;
+    for (int i = 0; i < nThread; ++i)
+    {
+        vecThread.emplace_back([pSpec, i, nRound, &nMismatch]()
+        {
+            cli::CParseContext ctx(pSpec);
+            int nLocal = 0;
+            for (int k = 0; k < nRound; ++k)
+            {
+                nLocal += FeedOnce(ctx, i, k);
+            }
+            nMismatch += nLocal;
+        });
+    }
+    for (auto& th : vecThread)
+    {
+        th.join();
+    }
+    return nMismatch;
+}
+
+} // namespace
+
+DEF_TAST(thread_context, "test parse context share the option setup")
+{
+    cli::CEnvBase env;
+    auto pSpec = ThreadSpec(env);
+    COUT(pSpec->m_bFrozen, true);
+    COUT(pSpec->OptionId("help") >= 0, true);
+
+    cli::CParseContext ctx(pSpec);
+    COUT(FeedOnce(ctx, 1, 2), 0);
+
+    DESC("required option is caught as setup");
+    const char* argv[] = {"thread", "--config=NONE", nullptr};
+    COUT(ctx.Feed(2, argv), cli::ERROR_CODE_OPTION_REQUIRED);
+    COUT(ctx.HasError(), true);
+    ctx.ClearError();
+
+    DESC("help does not print in context");
+    const char* argvHelp[] = {"thread", "--help", nullptr};
+    COUT(ctx.Feed(2, argvHelp), cli::ERROR_CODE_HELP);
+
+    DESC("later setup copy the option setup, the shared one unchanged");
+    size_t nOption = pSpec->m_vecOptions.size();
+    env.Option('x', "extra", "extra option");
+    COUT(pSpec->m_vecOptions.size(), nOption);
+    COUT(env.OptionId("extra") >= 0, true);
+    COUT(pSpec->OptionId("extra"), -1);
+    COUT(env.Share() != pSpec, true);
+}
+
+DEF_TAST(thread_stress, "test concurrent parse with shared option setup")
+{
+    cli::CEnvBase env;
+    auto pSpec = ThreadSpec(env);
+
+    // see thread_feed of bench-cliop for the scaling
+    int nRound = 200;
+    for (int nThread = 1; nThread <= 8; nThread *= 2)
+    {
+        COUT(nThread);
+        COUT(RunThreads(pSpec, nThread, nRound), 0);
+    }
+}
+
+DEF_TAST(thread_error_handler, "test set error handler while reporting in other threads")
+{
+    cli::CEnvBase env;
+    env.Catch(cli::ERROR_CODE_OPTION_UNKNOWN);
+    auto pSpec = env.Share();
+
+    std::atomic<int> nReport(0);
+    cli::FErrorHandler fnCount = [&nReport](int, const std::string&) { nReport++; };
+    cli::FErrorHandler fnOld = cli::SetErrorHandler(fnCount);
+
+    std::atomic<bool> bStop(false);
+    std::thread thSetter([&]()
+    {
+        while (!bStop)
+        {
+            cli::SetErrorHandler(fnCount);
+        }
+    });
+
+    int nThread = 4;
+    int nRound = 1000;
+    std::vector<std::thread> vecThread;
+    for (int i = 0; i < nThread; ++i)
+    {
+        vecThread.emplace_back([pSpec, nRound]()
+        {
+            cli::CParseContext ctx(pSpec);
+            const char* argv[] = {"thread", "--unknown=1", "--config=NONE", nullptr};
+            for (int k = 0; k < nRound; ++k)
+            {
+                ctx.Feed(3, argv);
+                ctx.ClearError();
+            }
+        });
+    }
+    for (auto& th : vecThread)
+    {
+        th.join();
+    }
+    bStop = true;
+    thSetter.join();
+    cli::SetErrorHandler(fnOld);
+    COUT(nReport.load(), nThread * nRound);
+}
+
+DEF_TAST(thread_snapshot, "test reader threads get published snapshot without lock")
+{
+    cli::CEnvBase env;
+    env.Set("--alpha=", "the first value")
+        .Set("--beta=", "the same as alpha")
+        .Set("--user=?", "required user name")
+        .Set("--mode= [fast]", "has default")
+        .Catch(cli::ERROR_CODE_OPTION_REQUIRED)
+        .PublishSnapshot();
+    cli::CSnapshotReader stReader(env.Publisher());
+    COUT(stReader.Current() == nullptr, true);
+
+    COUT(env.Feed({"--alpha=1", "--beta=1", "--user=me", "--extra=x", "in.txt", "--config=NONE"}), 0);
+    const cli::CArgSnapshot* pSnapshot = stReader.Current();
+    COUT(pSnapshot != nullptr, true);
+    COUT(pSnapshot->Version(), 1);
+    COUT(pSnapshot->Has("alpha"), true);
+    COUT(pSnapshot->Has("mode"), false);
+    COUT(pSnapshot->Get("mode"), std::string("fast"));
+    COUT(pSnapshot->Get("extra"), std::string("x"));
+    COUT(pSnapshot->Has("extra"), true);
+    COUT(pSnapshot->Get(1), std::string("in.txt"));
+    COUT(pSnapshot->Argc(), 1);
+    COUT(pSnapshot->Get("nothing").empty(), true);
+    int iAlpha = 0;
+    COUT(pSnapshot->Get("alpha", iAlpha), true);
+    COUT(iAlpha, 1);
+
+    DESC("failed parse is not published");
+    COUT(env.Feed({"--alpha=2", "--beta=2", "--config=NONE"}), cli::ERROR_CODE_OPTION_REQUIRED);
+    env.ClearError();
+    COUT(stReader.Current() == pSnapshot, true);
+    COUT(env.Publisher().Version(), 1);
+
+    DESC("readers always see alpha equal to beta while writer feeds");
+    std::atomic<bool> bStop(false);
+    std::atomic<int> nMismatch(0);
+    std::atomic<uint64_t> nRead(0);
+    std::vector<std::thread> vecThread;
+    for (int i = 0; i < 4; ++i)
+    {
+        vecThread.emplace_back([&env, &bStop, &nMismatch, &nRead]()
+        {
+            cli::CSnapshotReader stReader(env.Publisher());
+            uint64_t uLast = 0;
+            uint64_t nLocal = 0;
+            while (!bStop)
+            {
+                const cli::CArgSnapshot* pSnapshot = stReader.Current();
+                if (pSnapshot->Get("alpha") != pSnapshot->Get("beta") || pSnapshot->Version() < uLast)
+                {
+                    nMismatch++;
+                }
+                uLast = pSnapshot->Version();
+                nLocal++;
+            }
+            nRead += nLocal;
+        });
+    }
+
+    cli::FErrorHandler fnOld = cli::SetErrorHandler([](int, const std::string&) {});
+    int nRound = 2000;
+    for (int k = 0; k < nRound; ++k)
+    {
+        std::string strAlpha = "--alpha=" + std::to_string(k);
+        std::string strBeta = "--beta=" + std::to_string(k);
+        if (k % 10 == 0)
+        {
+            env.Feed({strAlpha, "--config=NONE"});
+            env.ClearError();
+        }
+        else
+        {
+            env.Feed({strAlpha, strBeta, "--user=me", "--config=NONE"});
+        }
+    }
+    cli::SetErrorHandler(fnOld);
+    bStop = true;
+    for (auto& th : vecThread)
+    {
+        th.join();
+    }
+    COUT(nMismatch.load(), 0);
+    COUT(env.Publisher().Version(), 1 + nRound - nRound / 10);
+    COUT(stReader.Current()->Get("alpha"), std::to_string(nRound - 1));
+
+    DESC("read current snapshot when not changed does not allocate");
+    // see snapshot_read of bench-cliop for the read cost
+    bench::CAllocScope scope;
+    size_t nSum = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        nSum += stReader.Current()->Get("alpha").size();
+    }
+    COUT(scope.Count(), 0);
+    COUT(nSum > 0, true);
+}